@@ -52,6 +52,58 @@ struct FunctionTraits<R(T1,T2,T3,T4,T5)> : FunctionTraits<R(T1,T2,T3,T4)>
 	typedef T5 arg4_type;
 };
 
+#ifdef QST_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+// functions with more arguments than the specializations above cover.
+// Only the argument count and result type are provided.
+template <class R, class... Args>
+struct FunctionTraits<R(Args...)>
+{
+	enum { count = sizeof...(Args) };
+	typedef R result_type;
+};
+#endif
+
+#if defined(QST_COMPILER_SUPPORTS_DECLTYPE) && defined(QST_COMPILER_SUPPORTS_VARIADIC_TEMPLATES)
+
+// extract the signature of a function object's operator(),
+// including the call operators of const and mutable lambdas
+template <class CallOperator>
+struct CallOperatorSignature;
+
+template <class R, class Class, class... Args>
+struct CallOperatorSignature<R (Class::*)(Args...)>
+{
+	typedef R type(Args...);
+};
+
+template <class R, class Class, class... Args>
+struct CallOperatorSignature<R (Class::*)(Args...) const>
+{
+	typedef R type(Args...);
+};
+
+template <class T, bool IsClass = qst_functional::is_class<T>::value>
+struct ExtractSignatureImpl
+{
+	typedef T type;
+};
+
+template <class T>
+struct ExtractSignatureImpl<T,true>
+{
+	typedef typename CallOperatorSignature<decltype(&T::operator())>::type type;
+};
+
+// extract the function signature from an input type T,
+// where T may be a function pointer or function object.  Lambdas and
+// other classes with a single, non-template operator() are supported.
+template <class T>
+struct ExtractSignature : ExtractSignatureImpl<T>
+{
+};
+
+#else
+
 // extract the function signature from an input type T,
 // where T may be a function pointer or function object
 template <class T>
@@ -60,6 +112,8 @@ struct ExtractSignature
 	typedef T type;
 };
 
+#endif
+
 template <class T>
 struct ExtractSignature<T*>
 {
@@ -78,6 +132,14 @@ struct ExtractSignature<Signature Class::*>
 	typedef Signature type;
 };
 
+#ifdef QST_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+template <class R, class Class, class... Args>
+struct ExtractSignature<R (Class::*)(Args...) const>
+{
+	typedef R type(Args...);
+};
+#endif
+
 template <class MemberFunc>
 struct MemberFuncResultType
 {
@@ -18,12 +18,13 @@
 
 // GCC
 // See http://gcc.gnu.org/projects/cxx0x.html
-#if (__GNUC__ >= 4) && defined(__GXX_EXPERIMENTAL_CXX0X__)
-#if (__GNUC_MINOR__ >= 3)
+#if defined(__GNUC__) && defined(__GXX_EXPERIMENTAL_CXX0X__)
+#define QST_GCC_VERSION (__GNUC__ * 100 + __GNUC_MINOR__)
+#if (QST_GCC_VERSION >= 403)
 #define QST_COMPILER_SUPPORTS_DECLTYPE
 #define QST_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
 #endif
-#if (__GNUC_MINOR__ >= 5)
+#if (QST_GCC_VERSION >= 405)
 #define QST_COMPILER_SUPPORTS_LAMBDAS
 #endif
 #endif
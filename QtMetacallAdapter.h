@@ -3,10 +3,15 @@
 #include "FunctionTraits.h"
 #include "QtCallback.h"
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QSharedData>
 #include <QtCore/QMetaObject>
 
-static const int QTMETACALL_MAX_ARGS = 6;
+#include <new>
+
+// maximum number of receiver arguments, matching the number
+// of arguments that a Qt signal can have
+static const int QTMETACALL_MAX_ARGS = 10;
 typedef int QtMetacallArgsArray[QTMETACALL_MAX_ARGS];
 
 namespace QtSignalTools
@@ -17,7 +22,62 @@ struct QtMetacallAdapterImplIface : public QSharedData
 {
 	virtual ~QtMetacallAdapterImplIface() {}
 	virtual bool invoke(const QGenericArgument* args, int count) const = 0;
+
+	// invokes the receiver with an argument vector in the form passed to
+	// qt_metacall(), where args[0] is the return value and args[1..count]
+	// point to the arguments.  'types' gives the Qt type IDs of the arguments,
+	// which must all be registered.
+	virtual bool invokeMetacall(void** args, const int* types, int count) const = 0;
+
 	virtual int getArgTypes(QtMetacallArgsArray args) const  = 0;
+
+	// returns true if invokeMetacall() knows the types of the arguments
+	// at compile time and so ignores 'types', in which case it can be
+	// used for arguments whose types are not registered
+	virtual bool hasStaticArgTypes() const { return false; }
+
+	// copy-constructs this implementation into 'storage', which must
+	// be large enough and suitably aligned
+	virtual QtMetacallAdapterImplIface* clone(void* storage) const = 0;
+};
+
+// inline storage for small QtMetacallAdapter implementations,
+// which avoids a heap allocation for typical function objects
+union QtMetacallAdapterStorage
+{
+	void* pointer;
+	double number;
+	qint64 integer;
+	char data[6 * sizeof(void*)];
+};
+
+// creates an implementation either in a QtMetacallAdapter's inline
+// storage or on the heap, depending on whether it fits
+template <class Impl, bool Inline = (sizeof(Impl) <= sizeof(QtMetacallAdapterStorage) &&
+                                     Q_ALIGNOF(Impl) <= Q_ALIGNOF(QtMetacallAdapterStorage))>
+struct QtMetacallAdapterAllocator
+{
+	static const bool isInline = true;
+
+	template <class Arg>
+	static QtMetacallAdapterImplIface* create(QtMetacallAdapterStorage* storage, const Arg& arg)
+	{
+		return new (storage->data) Impl(arg);
+	}
+};
+
+template <class Impl>
+struct QtMetacallAdapterAllocator<Impl,false>
+{
+	static const bool isInline = false;
+
+	template <class Arg>
+	static QtMetacallAdapterImplIface* create(QtMetacallAdapterStorage*, const Arg& arg)
+	{
+		QtMetacallAdapterImplIface* impl = new Impl(arg);
+		impl->ref.ref();
+		return impl;
+	}
 };
 
 struct QtCallbackImpl : public QtMetacallAdapterImplIface
@@ -41,6 +101,19 @@ struct QtCallbackImpl : public QtMetacallAdapterImplIface
 		return callback.invokeWithArgs(args[0], args[1], args[2], args[3], args[4], args[5]);
 	}
 
+	virtual bool invokeMetacall(void** _args, const int* types, int count) const {
+		const int MAX_ARGS = 6;
+		QGenericArgument args[MAX_ARGS];
+		for (int i=0; i < count && i < MAX_ARGS; i++) {
+			args[i] = QGenericArgument(QMetaType::typeName(types[i]), _args[i+1]);
+		}
+		return callback.invokeWithArgs(args[0], args[1], args[2], args[3], args[4], args[5]);
+	}
+
+	virtual QtMetacallAdapterImplIface* clone(void* storage) const {
+		return new (storage) QtCallbackImpl(*this);
+	}
+
 	virtual int getArgTypes(QtMetacallArgsArray args) const {
 		int count = qMin(callback.unboundParameterCount(), QTMETACALL_MAX_ARGS);
 		for (int i=0; i < count; i++) {
@@ -57,8 +130,9 @@ struct QtMetacallAdapterImplBase : QtMetacallAdapterImplIface
 	// the functor's arguments
 	typedef FunctionTraits<typename ExtractSignature<Functor>::type> traits;
 
-	// the function pointer or function object to invoke
-	Functor functor;
+	// the function pointer or function object to invoke.  This is
+	// mutable so that the adapter can invoke mutable lambdas.
+	mutable Functor functor;
 
 	QtMetacallAdapterImplBase(const Functor& _f)
 	: functor(_f)
@@ -87,6 +161,102 @@ struct QtMetacallAdapterImplBase : QtMetacallAdapterImplIface
 	}
 };
 
+#ifdef QST_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+
+template <int... Indexes>
+struct IndexSequence
+{
+};
+
+// generates IndexSequence<0, 1, ... N-1>
+template <int N, int... Indexes>
+struct MakeIndexSequence : MakeIndexSequence<N-1, N-1, Indexes...>
+{
+};
+
+template <int... Indexes>
+struct MakeIndexSequence<0, Indexes...>
+{
+	typedef IndexSequence<Indexes...> type;
+};
+
+// argument type tables and dispatch for a receiver signature
+template <class Signature>
+struct QtMetacallSignature;
+
+template <class R, class... Args>
+struct QtMetacallSignature<R(Args...)>
+{
+	typedef typename MakeIndexSequence<sizeof...(Args)>::type Indexes;
+
+	// returns the type IDs of the receiver's arguments.  The table
+	// is filled on first use, with a trailing 0 so that it is never empty.
+	static const int* argTypes()
+	{
+		static const int types[] = {
+			qMetaTypeId<typename qst_functional::remove_const<
+			  typename qst_functional::remove_reference<Args>::type>::type>()..., 0
+		};
+		return types;
+	}
+
+	template <class Functor, int... I>
+	static void invoke(Functor& functor, const QGenericArgument* args, IndexSequence<I...>)
+	{
+		(void)args;
+		functor(*reinterpret_cast<typename qst_functional::remove_reference<Args>::type*>(args[I].data())...);
+	}
+
+	template <class Functor, int... I>
+	static void invokeMetacall(Functor& functor, void** args, IndexSequence<I...>)
+	{
+		(void)args;
+		functor(*reinterpret_cast<typename qst_functional::remove_reference<Args>::type*>(args[I+1])...);
+	}
+};
+
+template <class Functor, int ArgCount>
+struct QtMetacallAdapterImpl : QtMetacallAdapterImplBase<Functor>
+{
+	typedef QtMetacallAdapterImplBase<Functor> Base;
+	typedef QtMetacallSignature<typename ExtractSignature<Functor>::type> Signature;
+
+	QtMetacallAdapterImpl(const Functor& functor)
+	: Base(functor)
+	{}
+
+	virtual bool invoke(const QGenericArgument* args, int count) const {
+		if (count < ArgCount) {
+			return false;
+		}
+		Signature::invoke(Base::functor, args, typename Signature::Indexes());
+		return true;
+	}
+
+	virtual bool invokeMetacall(void** args, const int* types, int count) const {
+		(void)types;
+		if (count < ArgCount) {
+			return false;
+		}
+		Signature::invokeMetacall(Base::functor, args, typename Signature::Indexes());
+		return true;
+	}
+
+	virtual QtMetacallAdapterImplIface* clone(void* storage) const {
+		return new (storage) QtMetacallAdapterImpl(*this);
+	}
+
+	virtual int getArgTypes(QtMetacallArgsArray args) const {
+		const int* types = Signature::argTypes();
+		for (int i=0; i < ArgCount; i++) {
+			args[i] = types[i];
+		}
+		return ArgCount;
+	}
+};
+
+#else
+
 template <class Functor, int ArgCount>
 struct QtMetacallAdapterImpl;
 
@@ -94,6 +264,10 @@ struct QtMetacallAdapterImpl;
 // to the type expected by the Nth functor parameter
 #define QMA_CAST_ARG(N) *reinterpret_cast<typename Base::traits::arg##N##_type*>(args[N].data())
 
+// extract the Nth argument from a qt_metacall() argument vector, where
+// the first entry is the return value
+#define QMA_CAST_METACALL_ARG(N) *reinterpret_cast<typename Base::traits::arg##N##_type*>(args[N+1])
+
 // returns the type of the Nth argument that the receiver expects
 #define QMA_ARG_TYPE(N) Base::template argType<typename Base::traits::arg##N##_type>()
 
@@ -101,13 +275,13 @@ struct QtMetacallAdapterImpl;
 // that take 'argCount' arguments.
 //
 // 'invokeExpr' is the expression passed to the functor to call it with
-// the appropriate args
+// the appropriate args and 'metacallExpr' is the equivalent expression
+// for a qt_metacall() argument vector
 //
 // 'argTypesExpr' is a comma-separated list of argument type IDs for
 // the arguments which the receiver expects.
 //
-// In C++11, this macro could be replaced with variadic templates
-#define QMA_DECLARE_ADAPTER_IMPL(argCount, invokeExpr, argTypesExpr) \
+#define QMA_DECLARE_ADAPTER_IMPL(argCount, invokeExpr, metacallExpr, argTypesExpr) \
   template <class Functor> \
   struct QtMetacallAdapterImpl<Functor,argCount> \
    : QtMetacallAdapterImplBase<Functor> \
@@ -122,16 +296,29 @@ struct QtMetacallAdapterImpl;
 	  Base::functor(invokeExpr);\
 	  return true;\
 	}\
+	virtual bool invokeMetacall(void** args, const int* types, int count) const { \
+	  (void)args;\
+	  (void)types;\
+	  if (count < argCount) {\
+	    return false; \
+	  }\
+	  Base::functor(metacallExpr);\
+	  return true;\
+	}\
+	virtual QtMetacallAdapterImplIface* clone(void* storage) const {\
+	  return new (storage) QtMetacallAdapterImpl(*this);\
+	}\
 	virtual int getArgTypes(QtMetacallArgsArray args) const {\
 		(void)args;\
 		return Base::fillArgTypes(args, argCount, argTypesExpr);\
 	}\
   };
 
-QMA_DECLARE_ADAPTER_IMPL(0,/* empty */, 0 /* empty */)
+QMA_DECLARE_ADAPTER_IMPL(0,/* empty */, /* empty */, 0 /* empty */)
 
 QMA_DECLARE_ADAPTER_IMPL(1,
   QMA_CAST_ARG(0),
+  QMA_CAST_METACALL_ARG(0),
   QMA_ARG_TYPE(0)
 )
 
@@ -139,59 +326,122 @@ QMA_DECLARE_ADAPTER_IMPL(1,
 
 QMA_DECLARE_ADAPTER_IMPL(2,
   QMA_CAST_ARG(0) QMA_COMMA QMA_CAST_ARG(1),
+  QMA_CAST_METACALL_ARG(0) QMA_COMMA QMA_CAST_METACALL_ARG(1),
   QMA_ARG_TYPE(0) QMA_COMMA QMA_ARG_TYPE(1)
 )
 
 QMA_DECLARE_ADAPTER_IMPL(3,
   QMA_CAST_ARG(0) QMA_COMMA QMA_CAST_ARG(1) QMA_COMMA QMA_CAST_ARG(2),
+  QMA_CAST_METACALL_ARG(0) QMA_COMMA QMA_CAST_METACALL_ARG(1) QMA_COMMA QMA_CAST_METACALL_ARG(2),
   QMA_ARG_TYPE(0) QMA_COMMA QMA_ARG_TYPE(1) QMA_COMMA QMA_ARG_TYPE(2)
 )
 	
 QMA_DECLARE_ADAPTER_IMPL(4,
   QMA_CAST_ARG(0) QMA_COMMA QMA_CAST_ARG(1) QMA_COMMA QMA_CAST_ARG(2) QMA_COMMA QMA_CAST_ARG(3),
+  QMA_CAST_METACALL_ARG(0) QMA_COMMA QMA_CAST_METACALL_ARG(1) QMA_COMMA QMA_CAST_METACALL_ARG(2) QMA_COMMA QMA_CAST_METACALL_ARG(3),
   QMA_ARG_TYPE(0) QMA_COMMA QMA_ARG_TYPE(1) QMA_COMMA QMA_ARG_TYPE(2) QMA_COMMA QMA_ARG_TYPE(3)
 )
 
 QMA_DECLARE_ADAPTER_IMPL(5,
   QMA_CAST_ARG(0) QMA_COMMA QMA_CAST_ARG(1) QMA_COMMA QMA_CAST_ARG(2) QMA_COMMA QMA_CAST_ARG(3) QMA_COMMA QMA_CAST_ARG(4),
+  QMA_CAST_METACALL_ARG(0) QMA_COMMA QMA_CAST_METACALL_ARG(1) QMA_COMMA QMA_CAST_METACALL_ARG(2) QMA_COMMA QMA_CAST_METACALL_ARG(3) QMA_COMMA QMA_CAST_METACALL_ARG(4),
   QMA_ARG_TYPE(0) QMA_COMMA QMA_ARG_TYPE(1) QMA_COMMA QMA_ARG_TYPE(2) QMA_COMMA QMA_ARG_TYPE(3) QMA_COMMA QMA_ARG_TYPE(4)
 )
 
+#endif // QST_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+
 }
 
 /** A wrapper around either a QtCallback or a function object (eg.
  * std::tr1::function, boost::function, a C++11 lambda)
  * which can invoke the function given an array of QGenericArgument objects.
+ *
+ * Small function objects are stored inline in the adapter, larger ones
+ * are allocated on the heap.
+ *
+ * Copying an adapter which stores its function object inline copies the
+ * function object, so a stateful functor invoked through the copy does
+ * not affect the original.  Function objects stored on the heap are
+ * shared between copies.  Code which needs the state of a functor to
+ * persist between calls should invoke the adapter it was bound to
+ * rather than a copy of it.
  */
 class QtMetacallAdapter
 {
 public:
 	QtMetacallAdapter()
+	: m_impl(0)
+	, m_isInline(false)
+	, m_id(0)
 	{}
 
 	QtMetacallAdapter(const QtCallback& callback)
-	: m_impl(new QtSignalTools::QtCallbackImpl(callback))
-	{}
+	: m_isInline(QtSignalTools::QtMetacallAdapterAllocator<QtSignalTools::QtCallbackImpl>::isInline)
+	, m_id(nextId())
+	{
+		m_impl = QtSignalTools::QtMetacallAdapterAllocator<QtSignalTools::QtCallbackImpl>::create(&m_storage, callback);
+	}
 
 	/** Construct a QtMetacallAdapter which invokes a function object
 	 * (eg. std::function or boost::function)
 	 */
 	template <template <class Signature> class FunctionObject, class Signature>
 	QtMetacallAdapter(const FunctionObject<Signature>& t)
-	: m_impl(new QtSignalTools::QtMetacallAdapterImpl<FunctionObject<Signature>,QtSignalTools::FunctionTraits<Signature>::count>(t))
+	: m_id(nextId())
 	{
+		typedef QtSignalTools::QtMetacallAdapterImpl<FunctionObject<Signature>,QtSignalTools::FunctionTraits<Signature>::count> Impl;
+		m_isInline = QtSignalTools::QtMetacallAdapterAllocator<Impl>::isInline;
+		m_impl = QtSignalTools::QtMetacallAdapterAllocator<Impl>::create(&m_storage, t);
 	}
 
-	/** Construct a QtMetacallAdapter which invokes a plain function */
+	/** Construct a QtMetacallAdapter which invokes a plain function or,
+	 * when the compiler supports C++11, a lambda or other function object
+	 * with a single non-template operator().  The function object is stored
+	 * directly without needing to be wrapped in std::function.
+	 */
 	template <class Functor>
 	QtMetacallAdapter(Functor f)
-	: m_impl(new QtSignalTools::QtMetacallAdapterImpl<Functor, QtSignalTools::FunctionTraits<typename QtSignalTools::ExtractSignature<Functor>::type>::count>(f))
+	: m_id(nextId())
 	{
+		typedef QtSignalTools::QtMetacallAdapterImpl<Functor, QtSignalTools::FunctionTraits<typename QtSignalTools::ExtractSignature<Functor>::type>::count> Impl;
+		m_isInline = QtSignalTools::QtMetacallAdapterAllocator<Impl>::isInline;
+		m_impl = QtSignalTools::QtMetacallAdapterAllocator<Impl>::create(&m_storage, f);
+	}
+
+	/** Construct a QtMetacallAdapter which uses a custom implementation
+	 * of type @p Impl, constructed from @p arg.
+	 */
+	template <class Impl, class Arg>
+	static QtMetacallAdapter fromImpl(const Arg& arg)
+	{
+		QtMetacallAdapter adapter;
+		adapter.m_id = nextId();
+		adapter.m_isInline = QtSignalTools::QtMetacallAdapterAllocator<Impl>::isInline;
+		adapter.m_impl = QtSignalTools::QtMetacallAdapterAllocator<Impl>::create(&adapter.m_storage, arg);
+		return adapter;
 	}
 
 	QtMetacallAdapter(const QtMetacallAdapter& other)
-	: m_impl(other.m_impl)
-	{}
+	: m_impl(0)
+	, m_isInline(false)
+	, m_id(0)
+	{
+		copyFrom(other);
+	}
+
+	~QtMetacallAdapter()
+	{
+		release();
+	}
+
+	QtMetacallAdapter& operator=(const QtMetacallAdapter& other)
+	{
+		if (this != &other) {
+			release();
+			copyFrom(other);
+		}
+		return *this;
+	}
 
 	/** Attempts to invoke the receiver with a given set of arguments from
 	 * a signal invocation.
@@ -204,6 +454,20 @@ public:
 		return m_impl->invoke(args, count);
 	}
 
+	/** Attempts to invoke the receiver with the argument vector passed to
+	 * qt_metacall() for a signal emission, avoiding the need to wrap each
+	 * argument in a QGenericArgument.  args[0] is the return value slot
+	 * and args[1..count] point to the arguments, whose registered Qt
+	 * type IDs are given by @p types.
+	 */
+	bool invokeMetacall(void** args, const int* types, int count) const
+	{
+		if (!m_impl) {
+			return false;
+		}
+		return m_impl->invokeMetacall(args, types, count);
+	}
+
 	/** Retrieves the count and types of arguments expected by the receiver */
 	int getArgTypes(QtMetacallArgsArray args) const
 	{
@@ -213,22 +477,80 @@ public:
 		return m_impl->getArgTypes(args);
 	}
 
+	/** Returns true if invokeMetacall() does not need the Qt type IDs of
+	 * the arguments, because the receiver's argument types were checked
+	 * at compile time.  Arguments of types which are not registered with
+	 * Qt can then be passed to invokeMetacall() with a type ID of 0.
+	 */
+	bool hasStaticArgTypes() const
+	{
+		return m_impl && m_impl->hasStaticArgTypes();
+	}
+
 	bool isNull() const
 	{
-		return m_impl.data() == 0;
+		return m_impl == 0;
 	}
 
+	/** Returns true if this adapter and @p other are copies of the same
+	 * original adapter.  Adapters constructed separately from the same
+	 * function compare unequal.
+	 */
 	bool operator==(const QtMetacallAdapter& other) const
 	{
-		return m_impl == other.m_impl;
+		return m_id == other.m_id;
 	}
 
 	bool operator!=(const QtMetacallAdapter& other) const
 	{
-		return m_impl != other.m_impl;
+		return m_id != other.m_id;
 	}
 
 private:
-	QSharedDataPointer<QtSignalTools::QtMetacallAdapterImplIface> m_impl;
+	// returns a new identity for an adapter constructed from a callback.
+	// Copies of an adapter share its identity.
+	static int nextId()
+	{
+		static QBasicAtomicInt lastId = Q_BASIC_ATOMIC_INITIALIZER(0);
+		return lastId.fetchAndAddRelaxed(1) + 1;
+	}
+
+	// inline implementations are cloned into this adapter's storage,
+	// heap-allocated ones are shared by reference
+	void copyFrom(const QtMetacallAdapter& other)
+	{
+		m_impl = 0;
+		m_isInline = other.m_isInline;
+		m_id = other.m_id;
+		if (!other.m_impl) {
+			return;
+		}
+		if (m_isInline) {
+			m_impl = other.m_impl->clone(m_storage.data);
+		} else {
+			other.m_impl->ref.ref();
+			m_impl = other.m_impl;
+		}
+	}
+
+	void release()
+	{
+		if (!m_impl) {
+			return;
+		}
+		if (m_isInline) {
+			m_impl->~QtMetacallAdapterImplIface();
+		} else if (!m_impl->ref.deref()) {
+			delete m_impl;
+		}
+		m_impl = 0;
+	}
+
+	// points either into m_storage or to a heap-allocated
+	// implementation shared between copies
+	QtSignalTools::QtMetacallAdapterImplIface* m_impl;
+	bool m_isInline;
+	int m_id;
+	QtSignalTools::QtMetacallAdapterStorage m_storage;
 };
 
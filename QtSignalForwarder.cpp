@@ -1,15 +1,40 @@
 #include "QtSignalForwarder.h"
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QBasicTimer>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
+#if QT_VERSION >= QT_VERSION_CHECK(4,7,0)
+#include <QtCore/QElapsedTimer>
+#else
+#include <QtCore/QTime>
+#endif
 #include <QtCore/QMutex>
 #include <QtCore/QMutexLocker>
+#include <QtCore/QSet>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QThread>
-#include <QtCore/QTimer>
 #include <QThreadStorage>
 
-// method index of QObject::destroyed(QObject*) signal
+#ifdef QT_GUI_LIB
+#include <QtGui/QHoverEvent>
+#include <QtGui/QMouseEvent>
+#include <QtGui/QMoveEvent>
+#include <QtGui/QResizeEvent>
+#include <QtGui/QWheelEvent>
+#endif
+
+#include <algorithm>
+
+// method indexes of the QObject::destroyed(QObject*) signal and
+// its clone for the default argument, QObject::destroyed()
 const int DESTROYED_SIGNAL_INDEX = 0;
+const int DESTROYED_NO_ARGS_SIGNAL_INDEX = 1;
+
+static inline bool isDestroyedSignal(int signalIndex)
+{
+	return signalIndex == DESTROYED_SIGNAL_INDEX || signalIndex == DESTROYED_NO_ARGS_SIGNAL_INDEX;
+}
 
 // minimum ID for method IDs used in signal bindings.
 //
@@ -17,229 +42,2295 @@ const int DESTROYED_SIGNAL_INDEX = 0;
 // determine which binding to invoke.
 const int BINDING_METHOD_MIN_ID = 1000;
 
-// limit on number of signal bindings per proxy.
+// number of signal connections which share each receiver object's
+// range of method IDs.
+//
 // Internally Qt stores receiver method IDs for signal connections
 // in a 16-bit uint, so there is a constraint that
-// BINDING_METHOD_MIN_ID + MAX_BINDINGS_PER_PROXY <= 2^16
-const int MAX_BINDINGS_PER_PROXY = 10000;
+// BINDING_METHOD_MIN_ID + CONNECTIONS_PER_PAGE <= 2^16.  Connections beyond
+// the first page use additional receiver objects owned by the proxy.  The page
+// size is kept well below the limit as some QObject operations are linear
+// in the number of connections to a receiver.
+const int CONNECTIONS_PER_PAGE = 8192;
+
+// minimum capacity of a hash table before squeezeIfSparse()
+// will shrink it
+const int MIN_SQUEEZE_CAPACITY = 64;
+
+// number of binding slots tracked by each word in the
+// free slot bitmap
+const int SLOTS_PER_WORD = 32;
+
+// returns the index of the lowest set bit in a non-zero word
+static inline int lowestSetBit(quint32 word)
+{
+	Q_ASSERT(word != 0);
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctz(word);
+#else
+	int bit = 0;
+	while (!(word & 1)) {
+		word >>= 1;
+		++bit;
+	}
+	return bit;
+#endif
+}
+
+// returns the index of the lowest set bit in a non-zero 64-bit word
+static inline int lowestSetBit64(quint64 word)
+{
+	Q_ASSERT(word != 0);
+	quint32 low = quint32(word);
+	return low ? lowestSetBit(low) : 32 + lowestSetBit(quint32(word >> 32));
+}
+
+// number of bits of a tick count which select a bucket in each level
+// of the delayedCall() timer wheel, and the number of levels.
+//
+// With 1ms ticks the wheel spans 2^24 ms (about 4.6 hours).  Calls
+// which are due further ahead are cascaded through the last level
+// until they come within range.
+const int WHEEL_BITS = 6;
+const int WHEEL_SIZE = 1 << WHEEL_BITS;
+const int WHEEL_LEVELS = 4;
+
+// number of entries which the delayedCall() timer wheel keeps allocated
+// when it has no pending calls
+const int WHEEL_IDLE_ENTRIES = 64;
+
+// number of binding slots checked for destroyed contexts each time
+// a binding using LazyContextTracking is added
+const int CONTEXT_SWEEP_STEP = 4;
+
+// maximum number of signal arguments which are passed on
+// to callbacks.  This matches the limit of QMetaMethod::invoke()
+const int MAX_SIGNAL_ARGS = 10;
+
+// default number of shared proxies per thread, see
+// QtSignalForwarder::setSharedProxyCount()
+const int DEFAULT_SHARED_PROXY_COUNT = 8;
+
+static QAtomicInt s_sharedProxyCount(DEFAULT_SHARED_PROXY_COUNT);
+
+static int loadSharedProxyCount()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+	return s_sharedProxyCount.load();
+#else
+	return s_sharedProxyCount;
+#endif
+}
+
+// pool of shared proxies for a thread.  Senders are assigned to a shard
+// by address and each shard's proxy is created when first used.
+struct SharedProxyPool
+{
+	QVector<QSharedPointer<QtSignalForwarder> > shards;
+};
+
+// per-thread pools of shared proxies used by the static connect() methods
+Q_GLOBAL_STATIC(QThreadStorage<SharedProxyPool>, sharedProxyPools)
+
+static QSharedPointer<QtSignalForwarder>& sharedProxyForShard(QObject* sender)
+{
+	SharedProxyPool& pool = sharedProxyPools()->localData();
+	if (pool.shards.isEmpty()) {
+		pool.shards.resize(loadSharedProxyCount());
+	}
+
+	// allocations are aligned, so discard the low bits of the address and
+	// mix the rest before reducing the hash to the number of shards
+	quint64 address = reinterpret_cast<quintptr>(sender);
+	quint32 hash = quint32(address >> 4) ^ quint32(address >> 36);
+	hash *= 0x9e3779b1u;
+	int shard = int((quint64(hash) * quint64(pool.shards.count())) >> 32);
+	return pool.shards[shard];
+}
+
+namespace QtSignalTools
+{
+
+// a receiver object which provides an additional range of method IDs
+// for a QtSignalForwarder's signal connections and forwards
+// invocations to the forwarder
+class MethodIdPage : public QObject
+{
+	// no Q_OBJECT macro here - see QtSignalForwarder::qt_metacall()
+
+	public:
+		MethodIdPage(QtSignalForwarder* forwarder, int firstConnectionId)
+			: QObject(forwarder)
+			, m_forwarder(forwarder)
+			, m_firstConnectionId(firstConnectionId)
+		{}
+
+		virtual int qt_metacall(QMetaObject::Call call, int methodId, void** arguments)
+		{
+			if (methodId >= BINDING_METHOD_MIN_ID && call == QMetaObject::InvokeMetaMethod) {
+				m_forwarder->invokeConnection(m_firstConnectionId + methodId - BINDING_METHOD_MIN_ID, arguments);
+				return -1;
+			} else {
+				return QObject::qt_metacall(call, methodId, arguments);
+			}
+		}
+
+	private:
+		QtSignalForwarder* m_forwarder;
+		int m_firstConnectionId;
+};
+
+// per-thread registry which tracks the destruction of the senders and
+// contexts which QtSignalForwarder proxies hold bindings for.
+//
+// Each tracked object has a single connection from its destroyed(QObject*)
+// signal to the registry, regardless of how many proxies or bindings refer to it.
+// All tracked objects share one method ID, as the destroyed object is passed
+// as the signal's argument.
+class DestructionRegistry : public QObject
+{
+	// no Q_OBJECT macro here - see QtSignalForwarder::qt_metacall()
+
+	public:
+		// adds @p proxy to the proxies which are notified when @p object
+		// is destroyed
+		void watch(QObject* object, QtSignalForwarder* proxy)
+		{
+			Watchers& watchers = m_watchers[object];
+			if (watchers.isEmpty()) {
+				QMetaObject::connect(object, DESTROYED_SIGNAL_INDEX, this, BINDING_METHOD_MIN_ID,
+				  Qt::DirectConnection, 0);
+			} else if (std::find(watchers.constData(), watchers.constData() + watchers.count(), proxy)
+			           != watchers.constData() + watchers.count()) {
+				return;
+			}
+			watchers.append(proxy);
+		}
+
+		void unwatch(QObject* object, QtSignalForwarder* proxy)
+		{
+			// a proxy which is destroyed while the registry is notifying
+			// watchers of @p object's destruction must not be notified
+			for (int i=0; i < m_notifications.count(); i++) {
+				if (m_notifications.at(i).object == object) {
+					Watchers& pending = *m_notifications.at(i).watchers;
+					std::replace(pending.data(), pending.data() + pending.count(), proxy,
+					  static_cast<QtSignalForwarder*>(0));
+				}
+			}
+
+			QHash<QObject*,Watchers>::iterator iter = m_watchers.find(object);
+			if (iter == m_watchers.end()) {
+				return;
+			}
+			Watchers& watchers = *iter;
+			for (int i=0; i < watchers.count(); i++) {
+				if (watchers.at(i) == proxy) {
+					watchers[i] = watchers.at(watchers.count() - 1);
+					watchers.removeLast();
+					break;
+				}
+			}
+			if (watchers.isEmpty()) {
+				m_watchers.erase(iter);
+				QMetaObject::disconnect(object, DESTROYED_SIGNAL_INDEX, this, BINDING_METHOD_MIN_ID);
+			}
+		}
+
+		virtual int qt_metacall(QMetaObject::Call call, int methodId, void** arguments)
+		{
+			if (methodId == BINDING_METHOD_MIN_ID && call == QMetaObject::InvokeMetaMethod) {
+				QObject* object = *reinterpret_cast<QObject**>(arguments[1]);
+
+				// the watchers are removed before notifying the proxies, which
+				// may add or remove watches for other objects in response.
+				// Proxies destroyed by an earlier watcher's callbacks are
+				// cleared from the list by unwatch().
+				Watchers watchers = m_watchers.take(object);
+				Notification notification;
+				notification.object = object;
+				notification.watchers = &watchers;
+				m_notifications.append(notification);
+				for (int i=0; i < watchers.count(); i++) {
+					if (watchers.at(i)) {
+						watchers.at(i)->objectDestroyed(object, arguments);
+					}
+				}
+				m_notifications.removeLast();
+				return -1;
+			} else {
+				return QObject::qt_metacall(call, methodId, arguments);
+			}
+		}
+
+	private:
+		typedef QVarLengthArray<QtSignalForwarder*,2> Watchers;
+
+		// destruction notifications in progress.  Callbacks may destroy
+		// further objects, so these can be nested.
+		struct Notification
+		{
+			QObject* object;
+			Watchers* watchers;
+		};
+
+		QHash<QObject*,Watchers> m_watchers;
+		QVarLengthArray<Notification,2> m_notifications;
+};
+
+// application-wide event filter which dispatches events to class
+// bindings, see QtSignalForwarder::connect(QObject*, const QMetaObject*, ...)
+//
+// Bindings are indexed by event type and then by the meta-object of the class
+// they were bound to.  An event of a type with no bindings costs a bit test,
+// otherwise one lookup is made for each class in the receiver's class hierarchy.
+class ClassEventFilter : public QObject
+{
+	public:
+		// a binding's callback, which is shared by reference so that
+		// eventFilter() can keep the callbacks it invokes alive without
+		// copying their function objects
+		struct Callback : public QSharedData
+		{
+			Callback(const QtMetacallAdapter& _adapter)
+				: adapter(_adapter)
+			{}
+
+			QtMetacallAdapter adapter;
+		};
+
+		struct Binding
+		{
+			Binding()
+				: hasScope(false)
+				, filter(0)
+			{}
+
+			bool hasScope;
+			QPointer<QObject> scope;
+			QtSignalForwarder::EventFilterFunc filter;
+			QExplicitlySharedDataPointer<Callback> callback;
+		};
+
+		// returns the filter installed on the application object, creating
+		// and installing it if @p create is true
+		static ClassEventFilter* instance(bool create);
+
+		void bind(const QMetaObject* metaObject, QEvent::Type event, const Binding& binding)
+		{
+			QVector<Binding>& bindings = m_bindings[event][metaObject];
+			removeDestroyedScopes(&bindings);
+			bindings.append(binding);
+			m_eventMask |= QtSignalForwarder::eventTypeBit(event);
+		}
+
+		// removes bindings for @p metaObject and @p event.  If @p matchScope is true,
+		// only bindings with @p scope as their scope are removed.
+		void unbind(const QMetaObject* metaObject, QEvent::Type event, bool matchScope, QObject* scope)
+		{
+			QHash<int,ClassBindings>::iterator typeIter = m_bindings.find(event);
+			if (typeIter == m_bindings.end()) {
+				return;
+			}
+			ClassBindings::iterator classIter = typeIter->find(metaObject);
+			if (classIter == typeIter->end()) {
+				return;
+			}
+
+			QVector<Binding>& bindings = *classIter;
+			if (matchScope) {
+				for (int i=bindings.count()-1; i >= 0; i--) {
+					const Binding& binding = bindings.at(i);
+					if (binding.hasScope == (scope != 0) && binding.scope == scope) {
+						bindings.remove(i);
+					}
+				}
+				removeDestroyedScopes(&bindings);
+			} else {
+				bindings.clear();
+			}
+
+			if (bindings.isEmpty()) {
+				typeIter->erase(classIter);
+				if (typeIter->isEmpty()) {
+					m_bindings.erase(typeIter);
+					updateEventMask();
+				}
+			}
+			if (m_bindings.isEmpty() && m_dispatchDepth == 0) {
+				parent()->removeEventFilter(this);
+				delete this;
+			}
+		}
+
+		virtual bool eventFilter(QObject* watched, QEvent* event)
+		{
+			if (!(m_eventMask & QtSignalForwarder::eventTypeBit(event->type()))) {
+				return false;
+			}
+			QHash<int,ClassBindings>::const_iterator typeIter = m_bindings.constFind(event->type());
+			if (typeIter == m_bindings.constEnd()) {
+				return false;
+			}
+
+			// callbacks may add or remove bindings, so collect the
+			// callbacks to invoke before invoking any of them
+			QVarLengthArray<QExplicitlySharedDataPointer<Callback>,4> callbacks;
+			const ClassBindings& classBindings = *typeIter;
+			for (const QMetaObject* metaObject = watched->metaObject(); metaObject;
+			     metaObject = metaObject->superClass()) {
+				ClassBindings::const_iterator classIter = classBindings.constFind(metaObject);
+				if (classIter == classBindings.constEnd()) {
+					continue;
+				}
+				const QVector<Binding>& bindings = *classIter;
+				for (int i=0; i < bindings.count(); i++) {
+					const Binding& binding = bindings.at(i);
+					if ((!binding.hasScope || isInScope(watched, binding.scope)) &&
+					    (!binding.filter || binding.filter(watched, event))) {
+						callbacks.append(binding.callback);
+					}
+				}
+			}
+
+			QGenericArgument arg = Q_ARG(QObject*, watched);
+			++m_dispatchDepth;
+			for (int i=0; i < callbacks.count(); i++) {
+				callbacks.at(i)->adapter.invoke(&arg, 1);
+			}
+			--m_dispatchDepth;
+
+			// the filter cannot delete itself while it is being invoked.
+			// It stays installed and remains the instance until the deferred
+			// deletion, so that bindings added in the meantime are kept
+			if (m_bindings.isEmpty() && m_dispatchDepth == 0) {
+				deleteLater();
+			}
+			return false;
+		}
+
+		virtual bool event(QEvent* event)
+		{
+			if (event->type() == QEvent::DeferredDelete) {
+				if (!m_bindings.isEmpty() || m_dispatchDepth > 0) {
+					// bindings were added since the deletion was requested
+					// or the event loop was entered from a callback
+					return true;
+				}
+				parent()->removeEventFilter(this);
+			}
+			return QObject::event(event);
+		}
+
+	private:
+		ClassEventFilter(QObject* application)
+			: QObject(application)
+			, m_eventMask(0)
+			, m_dispatchDepth(0)
+		{}
+
+		static bool isInScope(QObject* object, QObject* scope)
+		{
+			for (; object; object = object->parent()) {
+				if (object == scope) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		static void removeDestroyedScopes(QVector<Binding>* bindings)
+		{
+			for (int i=bindings->count()-1; i >= 0; i--) {
+				const Binding& binding = bindings->at(i);
+				if (binding.hasScope && !binding.scope) {
+					bindings->remove(i);
+				}
+			}
+		}
+
+		void updateEventMask()
+		{
+			m_eventMask = 0;
+			for (QHash<int,ClassBindings>::const_iterator iter = m_bindings.constBegin();
+			     iter != m_bindings.constEnd(); ++iter) {
+				m_eventMask |= QtSignalForwarder::eventTypeBit(iter.key());
+			}
+		}
+
+		typedef QHash<const QMetaObject*,QVector<Binding> > ClassBindings;
+
+		// map of event type -> class -> bindings
+		QHash<int,ClassBindings> m_bindings;
+		quint64 m_eventMask;
+		int m_dispatchDepth;
+};
+
+Q_GLOBAL_STATIC(QPointer<ClassEventFilter>, classEventFilter)
+
+ClassEventFilter* ClassEventFilter::instance(bool create)
+{
+	QPointer<ClassEventFilter>& filter = *classEventFilter();
+	if (!filter && create) {
+		QCoreApplication* application = QCoreApplication::instance();
+		filter = new ClassEventFilter(application);
+		application->installEventFilter(filter);
+	}
+	return filter;
+}
+
+// state for an event binding created by QtSignalForwarder::bindCoalesced()
+struct CoalescedEvent
+{
+	CoalescedEvent()
+		: sender(0)
+		, interval(0)
+		, pendingEvent(0)
+	{}
+
+	~CoalescedEvent()
+	{
+		delete pendingEvent;
+	}
+
+	QObject* sender;
+	int interval;
+	QtSignalForwarder::EventCallback callback;
+
+	// runs while a delivery is pending
+	QBasicTimer timer;
+
+	// copy of the latest event received since the last delivery
+	QEvent* pendingEvent;
+
+	private:
+		Q_DISABLE_COPY(CoalescedEvent)
+};
+
+// state for a signal binding created by QtSignalForwarder::bindDebounced()
+// or QtSignalForwarder::bindThrottled()
+//
+// The binding's timer is an entry in the thread's delayedCall() timer wheel.
+// Emissions which extend a debounce interval only move the deadline, and the
+// entry is scheduled again for the remaining time when it expires.
+struct RateLimiter
+{
+	RateLimiter()
+		: interval(0)
+		, debounce(false)
+		, edges(0)
+		, deadline(0)
+		, timerId(-1)
+		, timerGeneration(0)
+		, hasPendingCall(false)
+		, argCount(0)
+	{}
+
+	bool isTimerActive() const;
+	// schedules the timer to expire after @p delay ms
+	void startTimer(int delay);
+
+	int interval;
+	bool debounce;
+	int edges;
+
+	// the timer runs while emissions are being debounced or throttled
+	// and expires at the deadline, on the wheel's clock
+	QSharedPointer<TimerWheel> wheel;
+	qint64 deadline;
+	int timerId;
+	uint timerGeneration;
+
+	// callback for the timer, which refers to the binding
+	QtMetacallAdapter expiry;
+
+	// set if the callback should be invoked with the latest arguments
+	// when the timer expires
+	bool hasPendingCall;
+
+	// number of signal arguments which the callback takes and the
+	// values of those arguments from the latest emission
+	int argCount;
+	QVector<QVariant> args;
+};
+
+// the stages of a QtSignalForwarder::Pipeline attached to a binding
+struct PipelineStages
+{
+	PipelineStages()
+		: outputType(0)
+		, outputTypeName(0)
+	{}
+
+	~PipelineStages()
+	{
+		qDeleteAll(stages);
+	}
+
+	QVector<PipelineStage*> stages;
+
+	// type of the value produced by the last stage
+	int outputType;
+	const char* outputTypeName;
+
+	private:
+		Q_DISABLE_COPY(PipelineStages)
+};
+
+// per-thread scheduler for QtSignalForwarder::delayedCall().
+//
+// Pending calls are held in a hierarchical timer wheel with 1ms ticks,
+// so scheduling and firing a call are O(1) amortized.  The wheel is driven
+// by a single native timer which is set to expire at the next tick with
+// calls to make or a bucket to cascade into a lower level.
+class TimerWheel : public QObject
+{
+	public:
+		TimerWheel()
+			: m_currentTick(0)
+			, m_timerTick(0)
+			, m_freeEntry(-1)
+			, m_pendingCount(0)
+			, m_lastSequence(0)
+			, m_lastGeneration(0)
+			, m_dispatchDepth(0)
+		{
+			std::fill(m_buckets, m_buckets + WHEEL_LEVELS * WHEEL_SIZE, -1);
+			std::fill(m_bucketTails, m_bucketTails + WHEEL_LEVELS * WHEEL_SIZE, -1);
+			std::fill(m_occupied, m_occupied + WHEEL_LEVELS, 0);
+			m_clock.start();
+		}
+
+		// schedules a call to @p callback after @p delay ms and returns its
+		// entry ID.  The call is skipped if @p context is destroyed first.
+		int schedule(int delay, QObject* context, const QtMetacallAdapter& callback)
+		{
+			if (m_pendingCount == 0) {
+				// the wheel is empty, so it can be moved forwards
+				// without cascading any buckets
+				m_currentTick = qMax(m_currentTick, now());
+			}
+
+			int id = allocEntry();
+			Entry& entry = m_entries[id];
+			entry.due = now() + qMax(0, delay);
+			entry.sequence = ++m_lastSequence;
+			entry.hasContext = context != 0;
+			entry.context = context;
+			entry.callback = callback;
+			++m_pendingCount;
+
+			insert(id, m_currentTick + 1);
+			updateTimer();
+			return id;
+		}
+
+		uint generation(int id) const
+		{
+			return m_entries.at(id).generation;
+		}
+
+		bool isPending(int id, uint generation) const
+		{
+			return id >= 0 && id < m_entries.count() && m_entries.at(id).generation == generation &&
+			       m_entries.at(id).bucket != -1;
+		}
+
+		void cancel(int id, uint generation)
+		{
+			if (!isPending(id, generation)) {
+				return;
+			}
+			unlink(id);
+			releaseEntry(id);
+			if (m_pendingCount == 0) {
+				m_timer.stop();
+				trimEntries();
+			}
+		}
+
+		// returns the current time in ms, on the clock used for due times
+		qint64 now() const
+		{
+			return m_clock.elapsed();
+		}
+
+		bool reschedule(int id, uint generation, int delay)
+		{
+			if (!isPending(id, generation)) {
+				return false;
+			}
+			unlink(id);
+			m_entries[id].due = now() + qMax(0, delay);
+			m_entries[id].sequence = ++m_lastSequence;
+			insert(id, m_currentTick + 1);
+			updateTimer();
+			return true;
+		}
+
+	protected:
+		virtual void timerEvent(QTimerEvent* event)
+		{
+			if (event->timerId() != m_timer.timerId()) {
+				QObject::timerEvent(event);
+				return;
+			}
+			m_timer.stop();
+			advance(now());
+			updateTimer();
+			trimEntries();
+		}
+
+	private:
+		// bucket value for calls which have been removed from the
+		// wheel and are about to be made
+		enum { FiringBucket = -2 };
+
+		struct Entry
+		{
+			Entry()
+				: prev(-1)
+				, next(-1)
+				, bucket(-1)
+				, due(0)
+				, sequence(0)
+				, generation(0)
+				, hasContext(false)
+			{}
+
+			// links to the other entries in the same bucket or, for unused
+			// entries, the next unused entry
+			int prev;
+			int next;
+			int bucket;
+			qint64 due;
+			// order in which the entry was scheduled or rescheduled
+			uint sequence;
+			uint generation;
+			bool hasContext;
+			QPointer<QObject> context;
+			QtMetacallAdapter callback;
+		};
+
+		// generations are assigned from a counter for the whole wheel rather
+		// than per entry, so that they stay unique when entries are trimmed
+		int allocEntry()
+		{
+			int id = m_freeEntry;
+			if (id < 0) {
+				m_entries.append(Entry());
+				id = m_entries.count() - 1;
+			} else {
+				m_freeEntry = m_entries.at(id).next;
+			}
+			m_entries[id].generation = ++m_lastGeneration;
+			return id;
+		}
+
+		void releaseEntry(int id)
+		{
+			Entry& entry = m_entries[id];
+			entry.bucket = -1;
+			entry.prev = -1;
+			entry.next = m_freeEntry;
+			entry.hasContext = false;
+			entry.context = 0;
+			entry.callback = QtMetacallAdapter();
+			m_freeEntry = id;
+			--m_pendingCount;
+		}
+
+		// frees the storage for unused entries if there are no pending calls
+		// and no calls are being made
+		void trimEntries()
+		{
+			if (m_pendingCount == 0 && m_dispatchDepth == 0 &&
+			    m_entries.count() > WHEEL_IDLE_ENTRIES) {
+				m_entries = QVector<Entry>();
+				m_freeEntry = -1;
+			}
+		}
+
+		// adds an entry to the bucket for its due time, or for @p earliest
+		// if that is later.  Buckets are kept in order of Entry::sequence so
+		// that calls due at the same time are made in the order they were
+		// scheduled
+		void insert(int id, qint64 earliest)
+		{
+			Entry& entry = m_entries[id];
+			qint64 due = qMax(entry.due, earliest);
+			qint64 delta = due - m_currentTick;
+			int level = 0;
+			while (level < WHEEL_LEVELS - 1 && delta >= (Q_INT64_C(1) << (WHEEL_BITS * (level + 1)))) {
+				++level;
+			}
+			if (level == WHEEL_LEVELS - 1) {
+				due = qMin(due, m_currentTick + (Q_INT64_C(1) << (WHEEL_BITS * WHEEL_LEVELS)) - 1);
+			}
+			int index = int(due >> (WHEEL_BITS * level)) & (WHEEL_SIZE - 1);
+			int bucket = level * WHEEL_SIZE + index;
+
+			// new calls go at the end of the bucket, but cascaded calls may
+			// belong before calls which were scheduled later straight into
+			// a lower level
+			int prev = m_bucketTails[bucket];
+			while (prev >= 0 && int(m_entries.at(prev).sequence - entry.sequence) > 0) {
+				prev = m_entries.at(prev).prev;
+			}
+			int next = prev >= 0 ? m_entries.at(prev).next : m_buckets[bucket];
+
+			entry.bucket = bucket;
+			entry.prev = prev;
+			entry.next = next;
+			if (prev >= 0) {
+				m_entries[prev].next = id;
+			} else {
+				m_buckets[bucket] = id;
+			}
+			if (next >= 0) {
+				m_entries[next].prev = id;
+			} else {
+				m_bucketTails[bucket] = id;
+			}
+			m_occupied[level] |= Q_UINT64_C(1) << index;
+		}
+
+		// removes an entry from its bucket, if it is in one
+		void unlink(int id)
+		{
+			Entry& entry = m_entries[id];
+			int bucket = entry.bucket;
+			if (bucket < 0) {
+				return;
+			}
+			if (entry.prev >= 0) {
+				m_entries[entry.prev].next = entry.next;
+			} else {
+				m_buckets[bucket] = entry.next;
+			}
+			if (entry.next >= 0) {
+				m_entries[entry.next].prev = entry.prev;
+			} else {
+				m_bucketTails[bucket] = entry.prev;
+			}
+			if (m_buckets[bucket] < 0) {
+				m_occupied[bucket / WHEEL_SIZE] &= ~(Q_UINT64_C(1) << (bucket % WHEEL_SIZE));
+			}
+			entry.prev = -1;
+			entry.next = -1;
+			entry.bucket = FiringBucket;
+		}
+
+		// removes all entries from @p bucket and returns the first one
+		int takeBucket(int bucket)
+		{
+			int id = m_buckets[bucket];
+			m_buckets[bucket] = -1;
+			m_bucketTails[bucket] = -1;
+			m_occupied[bucket / WHEEL_SIZE] &= ~(Q_UINT64_C(1) << (bucket % WHEEL_SIZE));
+			return id;
+		}
+
+		// returns the next tick at which a bucket needs to be fired or
+		// cascaded, or -1 if the wheel is empty
+		qint64 nextTick() const
+		{
+			qint64 next = -1;
+			for (int level=0; level < WHEEL_LEVELS; level++) {
+				quint64 occupied = m_occupied[level];
+				if (!occupied) {
+					continue;
+				}
+				int shift = WHEEL_BITS * level;
+				int index = int(m_currentTick >> shift) & (WHEEL_SIZE - 1);
+				qint64 base = (m_currentTick >> (shift + WHEEL_BITS)) << (shift + WHEEL_BITS);
+
+				// buckets at or before the current index belong to the next
+				// rotation of this level
+				quint64 ahead = index == WHEEL_SIZE - 1 ? 0 : occupied & (~Q_UINT64_C(0) << (index + 1));
+				qint64 tick;
+				if (ahead) {
+					tick = base + (qint64(lowestSetBit64(ahead)) << shift);
+				} else {
+					tick = base + (qint64(WHEEL_SIZE + lowestSetBit64(occupied)) << shift);
+				}
+				if (next < 0 || tick < next) {
+					next = tick;
+				}
+			}
+			return next;
+		}
+
+		// makes the calls which are due at or before @p tick
+		void advance(qint64 tick)
+		{
+			for (;;) {
+				qint64 next = nextTick();
+				if (next < 0 || next > tick) {
+					break;
+				}
+				m_currentTick = next;
+
+				// move entries from higher levels whose bucket starts at
+				// this tick into lower levels.  Entries which are due at this
+				// tick go into the level 0 bucket which is about to be fired.
+				for (int level=WHEEL_LEVELS-1; level > 0; level--) {
+					int shift = WHEEL_BITS * level;
+					if ((next & ((Q_INT64_C(1) << shift) - 1)) == 0) {
+						int id = takeBucket(level * WHEEL_SIZE + (int(next >> shift) & (WHEEL_SIZE - 1)));
+						while (id >= 0) {
+							int nextId = m_entries.at(id).next;
+							insert(id, next);
+							id = nextId;
+						}
+					}
+				}
+				fireBucket(int(next) & (WHEEL_SIZE - 1));
+			}
+
+			// no buckets start between the current tick and @p tick
+			m_currentTick = qMax(m_currentTick, tick);
+		}
+
+		void fireBucket(int bucket)
+		{
+			// callbacks may schedule further calls, so take the
+			// calls to make before making any of them
+			QVarLengthArray<QPair<int,uint>,16> calls;
+			for (int id = takeBucket(bucket); id >= 0; id = m_entries.at(id).next) {
+				m_entries[id].bucket = FiringBucket;
+				calls.append(qMakePair(id, m_entries.at(id).generation));
+			}
+
+			++m_dispatchDepth;
+			for (int i=0; i < calls.count(); i++) {
+				int id = calls.at(i).first;
+				const Entry& entry = m_entries.at(id);
+				if (entry.generation != calls.at(i).second || entry.bucket != FiringBucket) {
+					continue;
+				}
+				bool contextDestroyed = entry.hasContext && entry.context.isNull();
+				QtMetacallAdapter callback = entry.callback;
+				releaseEntry(id);
+				if (!contextDestroyed) {
+					callback.invoke(0, 0);
+				}
+			}
+			--m_dispatchDepth;
+		}
+
+		// sets the native timer to expire at the next tick with work to do
+		void updateTimer()
+		{
+			if (m_pendingCount == 0) {
+				m_timer.stop();
+				return;
+			}
+			qint64 tick = nextTick();
+			if (m_timer.isActive() && m_timerTick <= tick) {
+				// expiring early is harmless, as advance() only makes calls
+				// which are due and the timer is then set again
+				return;
+			}
+			m_timerTick = tick;
+			m_timer.start(int(qMax(Q_INT64_C(0), tick - now())), this);
+		}
+
+#if QT_VERSION >= QT_VERSION_CHECK(4,7,0)
+		QElapsedTimer m_clock;
+#else
+		QTime m_clock;
+#endif
+		QBasicTimer m_timer;
+
+		// the last tick processed by advance() and the tick
+		// for which m_timer was set
+		qint64 m_currentTick;
+		qint64 m_timerTick;
+
+		QVector<Entry> m_entries;
+		int m_freeEntry;
+		int m_pendingCount;
+		// sources of Entry::sequence and Entry::generation values
+		uint m_lastSequence;
+		uint m_lastGeneration;
+		// depth of nested fireBucket() calls
+		int m_dispatchDepth;
+
+		// first and last entries in each bucket, indexed by (level * WHEEL_SIZE + index),
+		// and bitmasks of the non-empty buckets in each level
+		int m_buckets[WHEEL_LEVELS * WHEEL_SIZE];
+		int m_bucketTails[WHEEL_LEVELS * WHEEL_SIZE];
+		quint64 m_occupied[WHEEL_LEVELS];
+};
+
+inline bool RateLimiter::isTimerActive() const
+{
+	return wheel->isPending(timerId, timerGeneration);
+}
+
+inline void RateLimiter::startTimer(int delay)
+{
+	timerId = wheel->schedule(delay, 0, expiry);
+	timerGeneration = wheel->generation(timerId);
+}
+
+// timer wheel callback which ends the current interval of a binding
+// created by QtSignalForwarder::bindDebounced() or bindThrottled()
+struct RateLimitExpiry : public QtMetacallAdapterImplIface
+{
+	RateLimitExpiry(const QtSignalForwarder::Connection& _binding)
+		: binding(_binding)
+	{}
+
+	virtual bool invoke(const QGenericArgument*, int) const
+	{
+		QtSignalForwarder::rateLimitExpired(binding);
+		return true;
+	}
+
+	virtual bool invokeMetacall(void**, const int*, int) const
+	{
+		QtSignalForwarder::rateLimitExpired(binding);
+		return true;
+	}
+
+	virtual int getArgTypes(QtMetacallArgsArray) const
+	{
+		return 0;
+	}
+
+	virtual QtMetacallAdapterImplIface* clone(void* storage) const
+	{
+		return new (storage) RateLimitExpiry(*this);
+	}
+
+	QtSignalForwarder::Connection binding;
+};
+
+struct SignalDescriptor
+{
+	const QMetaObject* metaObject;
+	int signalIndex;
+	int paramCount;
+
+	// Qt type IDs of the signal's parameters.  Types which were not
+	// registered when the descriptor was created have an ID of 0.
+	// Descriptors are not modified once published, so these are
+	// resolved again on the next lookup by publishing a new descriptor.
+	int paramTypes[MAX_SIGNAL_ARGS];
+	bool hasUnresolvedTypes;
+
+	// normalized type names for the signal's parameters, for use
+	// with QGenericArgument
+	QList<QByteArray> paramTypeNames;
+};
+
+}
+
+using QtSignalTools::ClassEventFilter;
+using QtSignalTools::CoalescedEvent;
+using QtSignalTools::DestructionRegistry;
+using QtSignalTools::MethodIdPage;
+using QtSignalTools::PipelineStage;
+using QtSignalTools::PipelineStages;
+using QtSignalTools::RateLimiter;
+using QtSignalTools::RateLimitExpiry;
+using QtSignalTools::TimerWheel;
+using QtSignalTools::SignalDescriptor;
+
+// per-thread schedulers for delayedCall() and rate-limited bindings
+Q_GLOBAL_STATIC(QThreadStorage<QSharedPointer<TimerWheel> >, timerWheels)
+
+// returns the timer wheel for the current thread, creating it if necessary
+static QSharedPointer<TimerWheel> currentTimerWheel()
+{
+	QSharedPointer<TimerWheel>& wheel = timerWheels()->localData();
+	if (!wheel) {
+		wheel = QSharedPointer<TimerWheel>(new TimerWheel);
+	}
+	return wheel;
+}
+
+// returns a copy of @p event which can be kept after the event has
+// been delivered
+static QEvent* copyEvent(const QEvent* event)
+{
+	switch (event->type()) {
+#ifdef QT_GUI_LIB
+	case QEvent::MouseMove:
+	case QEvent::MouseButtonPress:
+	case QEvent::MouseButtonRelease:
+	case QEvent::MouseButtonDblClick:
+		return new QMouseEvent(*static_cast<const QMouseEvent*>(event));
+	case QEvent::Wheel:
+		return new QWheelEvent(*static_cast<const QWheelEvent*>(event));
+	case QEvent::HoverEnter:
+	case QEvent::HoverLeave:
+	case QEvent::HoverMove:
+		return new QHoverEvent(*static_cast<const QHoverEvent*>(event));
+	case QEvent::Move:
+		return new QMoveEvent(*static_cast<const QMoveEvent*>(event));
+	case QEvent::Resize:
+		return new QResizeEvent(*static_cast<const QResizeEvent*>(event));
+#endif
+	default:
+		return new QEvent(event->type());
+	}
+}
+
+typedef QPair<const QMetaObject*,int> SignalDescriptorKey;
+typedef QHash<SignalDescriptorKey,SignalDescriptor*> SignalDescriptorHash;
+
+// process-wide cache of signal descriptors.  Entries are never removed,
+// as meta-objects normally live for the lifetime of the process.
+// Descriptors are read without the lock once published, so a descriptor
+// whose types are resolved later is replaced rather than updated, and the
+// one it replaces is kept alive for the connections which refer to it.
+Q_GLOBAL_STATIC(SignalDescriptorHash, signalDescriptors)
+Q_GLOBAL_STATIC(QMutex, signalDescriptorsLock)
+
+// resolves the Qt type IDs of the parameters of @p descriptor which
+// were not registered when it was created, storing them in @p types.
+// Returns true if any of them have been registered since.
+static bool resolveParamTypes(const SignalDescriptor* descriptor, int* types)
+{
+	bool changed = false;
+	for (int i=0; i < descriptor->paramCount; i++) {
+		types[i] = descriptor->paramTypes[i];
+		if (types[i] == 0) {
+			types[i] = QMetaType::type(descriptor->paramTypeNames.at(i).constData());
+			changed = changed || types[i] != 0;
+		}
+	}
+	return changed;
+}
+
+static bool hasUnresolvedTypes(const SignalDescriptor* descriptor)
+{
+	const int* end = descriptor->paramTypes + descriptor->paramCount;
+	return std::find(descriptor->paramTypes, end, 0) != end;
+}
+
+// returns the shared descriptor for a signal, creating it if necessary
+const SignalDescriptor* signalDescriptor(const QMetaObject* metaObject, int signalIndex)
+{
+	QMutexLocker lock(signalDescriptorsLock());
+
+	SignalDescriptor*& descriptor = (*signalDescriptors())[qMakePair(metaObject, signalIndex)];
+	if (!descriptor) {
+		descriptor = new SignalDescriptor;
+		descriptor->metaObject = metaObject;
+		descriptor->signalIndex = signalIndex;
+		descriptor->paramTypeNames = metaObject->method(signalIndex).parameterTypes();
+		descriptor->paramCount = qMin(descriptor->paramTypeNames.count(), MAX_SIGNAL_ARGS);
+		for (int i=0; i < descriptor->paramCount; i++) {
+			descriptor->paramTypes[i] = 0;
+		}
+		// the new descriptor has not been published yet, so its
+		// types can be filled in directly
+		resolveParamTypes(descriptor, descriptor->paramTypes);
+		descriptor->hasUnresolvedTypes = hasUnresolvedTypes(descriptor);
+		return descriptor;
+	}
+
+	int types[MAX_SIGNAL_ARGS];
+	if (descriptor->hasUnresolvedTypes && resolveParamTypes(descriptor, types)) {
+		// publish a copy with the newly registered types, leaving the
+		// existing descriptor unchanged for the connections using it
+		SignalDescriptor* resolved = new SignalDescriptor(*descriptor);
+		std::copy(types, types + resolved->paramCount, resolved->paramTypes);
+		resolved->hasUnresolvedTypes = hasUnresolvedTypes(resolved);
+		descriptor = resolved;
+	}
+
+	return descriptor;
+}
+
+struct SignalIndexCacheKey
+{
+	SignalIndexCacheKey(const QMetaObject* _metaObject, const QByteArray& _signature)
+		: metaObject(_metaObject)
+		, signature(_signature)
+	{}
+
+	bool operator==(const SignalIndexCacheKey& other) const
+	{
+		return metaObject == other.metaObject && signature == other.signature;
+	}
+
+	const QMetaObject* metaObject;
+	QByteArray signature;
+};
+
+uint qHash(const SignalIndexCacheKey& key)
+{
+	return qHash(key.metaObject) ^ qHash(key.signature);
+}
+
+struct SignalIndexCache
+{
+	SignalIndexCache()
+		: hits(0)
+		, misses(0)
+	{}
+
+	QMutex lock;
+	QHash<SignalIndexCacheKey,int> entries;
+	int hits;
+	int misses;
+};
+
+// process-wide cache of (meta-object, signature) -> signal index lookups.
+// Failed lookups are not cached, so that mistyped or generated signatures
+// cannot grow the cache without bound.
+Q_GLOBAL_STATIC(SignalIndexCache, signalIndexCache)
+
+int qtObjectSignalIndex(const QObject* object, const char* signal)
+{
+	const QMetaObject* metaObject = object->metaObject();
+	SignalIndexCache* cache = signalIndexCache();
+	QMutexLocker lock(&cache->lock);
+
+	// the lookup key references the caller's string without copying it
+	QByteArray signature = QByteArray::fromRawData(signal + 1, qstrlen(signal + 1));
+	QHash<SignalIndexCacheKey,int>::const_iterator iter =
+	  cache->entries.constFind(SignalIndexCacheKey(metaObject, signature));
+	if (iter != cache->entries.constEnd()) {
+		++cache->hits;
+		return *iter;
+	}
+	++cache->misses;
+
+	int signalIndex = metaObject->indexOfMethod(signal + 1);
+	if (signalIndex < 0) {
+		signalIndex = metaObject->indexOfMethod(QMetaObject::normalizedSignature(signal + 1).constData());
+	}
+
+	if (signalIndex >= 0) {
+		cache->entries.insert(SignalIndexCacheKey(metaObject, QByteArray(signal + 1)), signalIndex);
+	}
+	return signalIndex;
+}
+
+QtSignalForwarder::QtSignalForwarder(QObject* parent)
+	: QObject(parent)
+	, m_pageConnectionCounts(1, 0)
+	, m_eventBindingCount(0)
+	, m_eventMask(0)
+	, m_lastGeneration(0)
+	, m_contextTracking(EagerContextTracking)
+	, m_sweepCursor(0)
+	, m_lazyContextBindingCount(0)
+	, m_dispatchDepth(0)
+{
+	std::fill(m_eventTypeCounts, m_eventTypeCounts + 64, 0);
+}
+
+// per-thread destruction registries.  Proxies keep a reference to the
+// registry for the thread which created them, so the registry outlives them.
+Q_GLOBAL_STATIC(QThreadStorage<QSharedPointer<DestructionRegistry> >, destructionRegistries)
+
+QtSignalForwarder::~QtSignalForwarder()
+{
+	if (m_destructionRegistry) {
+		QList<QObject*> watched = m_senderConnectionIds.uniqueKeys();
+		watched << m_contextBindingIds.uniqueKeys() << m_eventBindings.keys();
+		Q_FOREACH(QObject* object, watched) {
+			m_destructionRegistry->unwatch(object, this);
+		}
+	}
+}
+
+QtSignalForwarder::SignalIndexCacheStats QtSignalForwarder::signalIndexCacheStats()
+{
+	SignalIndexCache* cache = signalIndexCache();
+	QMutexLocker lock(&cache->lock);
+
+	SignalIndexCacheStats stats;
+	stats.hits = cache->hits;
+	stats.misses = cache->misses;
+	stats.size = cache->entries.count();
+	return stats;
+}
+
+void QtSignalForwarder::clearSignalIndexCache()
+{
+	SignalIndexCache* cache = signalIndexCache();
+	QMutexLocker lock(&cache->lock);
+
+	cache->entries.clear();
+	cache->hits = 0;
+	cache->misses = 0;
+}
+
+bool QtSignalForwarder::checkTypeMatch(const QtMetacallAdapter& callback, const int* paramTypes, int paramCount)
+{
+	int receiverArgTypes[QTMETACALL_MAX_ARGS] = {-1};
+	int receiverArgCount = callback.getArgTypes(receiverArgTypes);
+
+	for (int i=0; i < receiverArgCount; i++) {
+		if (i >= paramCount) {
+			qWarning() << "Missing argument" << i << ": "
+			  << "Receiver expects" << QLatin1String(QMetaType::typeName(receiverArgTypes[i]));
+			return false;
+		}
+		int type = paramTypes[i];
+		if (type != receiverArgTypes[i]) {
+			qWarning() << "Type mismatch for argument" << i << ": "
+			  << "Signal sends" << QLatin1String(QMetaType::typeName(type))
+			  << "receiver expects" << QLatin1String(QMetaType::typeName(receiverArgTypes[i]));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void QtSignalForwarder::setupDestroyNotify(QObject* object)
+{
+	if (!m_destructionRegistry) {
+		QSharedPointer<DestructionRegistry>& registry = destructionRegistries()->localData();
+		if (!registry) {
+			registry = QSharedPointer<DestructionRegistry>(new DestructionRegistry);
+		}
+		m_destructionRegistry = registry;
+	}
+	m_destructionRegistry->watch(object, this);
+}
+
+void QtSignalForwarder::releaseDestroyNotify(QObject* object)
+{
+	if (m_destructionRegistry && !m_senderConnectionIds.contains(object) &&
+	    !m_contextBindingIds.contains(object) && !m_eventBindings.contains(object)) {
+		m_destructionRegistry->unwatch(object, this);
+	}
+}
+
+void QtSignalForwarder::objectDestroyed(QObject* object, void** arguments)
+{
+	// bindings for the object's own destroyed() signals do not have a
+	// Qt connection, instead they are invoked here before the object's
+	// bindings are removed
+	QVarLengthArray<int,4> destroyedConnectionIds;
+	QHash<QObject*,int>::const_iterator iter = m_senderConnectionIds.find(object);
+	for (; iter != m_senderConnectionIds.end() && iter.key() == object; ++iter) {
+		if (isDestroyedSignal(signalConnection(*iter).signal->signalIndex)) {
+			destroyedConnectionIds.append(*iter);
+		}
+	}
+	for (int i=0; i < destroyedConnectionIds.count(); i++) {
+		// a callback may have removed the connection
+		if (signalConnection(destroyedConnectionIds.at(i)).sender == object) {
+			invokeConnection(destroyedConnectionIds.at(i), arguments);
+		}
+	}
+
+	unbindSender(object);
+}
+
+QtSignalForwarder::Connection QtSignalForwarder::bind(QObject* sender, const char* signal, QObject *context,
+	const QtMetacallAdapter& callback
+)
+{
+	int signalIndex = qtObjectSignalIndex(sender, signal);
+	if (signalIndex < 0) {
+		qWarning() << "No such signal" << signal << "for" << sender;
+		return Connection();
+	}
+
+	const SignalDescriptor* descriptor = signalDescriptor(sender->metaObject(), signalIndex);
+	if (!checkTypeMatch(callback, descriptor->paramTypes, descriptor->paramCount)) {
+		qWarning() << "Sender and receiver types do not match for" << signal+1;
+		return Connection();
+	}
+
+	int bindingId = bindSignal(sender, descriptor, context, callback);
+	if (bindingId < 0) {
+		return Connection();
+	}
+	return Connection(this, bindingId, m_signalBindings.at(bindingId).generation);
+}
+
+#ifdef QST_SUPPORTS_TYPED_SIGNALS
+QtSignalForwarder::Connection QtSignalForwarder::bindTypedSignal(QObject* sender, int signalIndex, QObject* context,
+	const QtMetacallAdapter& callback
+)
+{
+	if (signalIndex < 0) {
+		qWarning() << "No such signal for" << sender;
+		return Connection();
+	}
+
+	// argument types were checked when the binding was compiled
+	const SignalDescriptor* descriptor = signalDescriptor(sender->metaObject(), signalIndex);
+	int bindingId = bindSignal(sender, descriptor, context, callback);
+	if (bindingId < 0) {
+		return Connection();
+	}
+	return Connection(this, bindingId, m_signalBindings.at(bindingId).generation);
+}
+#endif
+
+QtSignalForwarder::Connection QtSignalForwarder::bind(QObject* sender, const char* signal, QObject* context,
+	const Pipeline& pipeline, const QtMetacallAdapter& callback
+)
+{
+	if (pipeline.isEmpty()) {
+		return bind(sender, signal, context, callback);
+	}
+
+	int signalIndex = qtObjectSignalIndex(sender, signal);
+	if (signalIndex < 0) {
+		qWarning() << "No such signal" << signal << "for" << sender;
+		return Connection();
+	}
+
+	const SignalDescriptor* descriptor = signalDescriptor(sender->metaObject(), signalIndex);
+	if (descriptor->paramCount < 1) {
+		qWarning() << "Signal" << signal+1 << "has no argument for the pipeline to process";
+		return Connection();
+	}
+
+	// check that each stage accepts the type produced by the previous one
+	QSharedPointer<PipelineStages> stages(new PipelineStages);
+	int valueType = descriptor->paramTypes[0];
+	for (int i=0; i < pipeline.m_stages.count(); i++) {
+		const PipelineStage* stage = pipeline.m_stages.at(i).data();
+		if (stage->inputType() != valueType) {
+			qWarning() << "Type mismatch for pipeline stage" << i << ": "
+			  << "Stage receives" << QLatin1String(QMetaType::typeName(valueType))
+			  << "but expects" << QLatin1String(QMetaType::typeName(stage->inputType()));
+			return Connection();
+		}
+		stages->stages << stage->clone();
+		valueType = stage->outputType();
+	}
+	stages->outputType = valueType;
+	stages->outputTypeName = QMetaType::typeName(valueType);
+
+	int paramTypes[MAX_SIGNAL_ARGS];
+	paramTypes[0] = valueType;
+	for (int i=1; i < descriptor->paramCount; i++) {
+		paramTypes[i] = descriptor->paramTypes[i];
+	}
+	if (!checkTypeMatch(callback, paramTypes, descriptor->paramCount)) {
+		qWarning() << "Pipeline output and receiver types do not match for" << signal+1;
+		return Connection();
+	}
+
+	int bindingId = bindSignal(sender, descriptor, context, callback);
+	if (bindingId < 0) {
+		return Connection();
+	}
+	m_signalBindings[bindingId].ensureExtras().pipeline = stages;
+	return Connection(this, bindingId, m_signalBindings.at(bindingId).generation);
+}
+
+QtSignalForwarder::Connection QtSignalForwarder::bindDebounced(QObject* sender, const char* signal, QObject* context,
+	const QtMetacallAdapter& callback, int interval
+)
+{
+	QSharedPointer<RateLimiter> rateLimiter(new RateLimiter);
+	rateLimiter->interval = qMax(0, interval);
+	rateLimiter->debounce = true;
+	return bindRateLimited(sender, signal, context, callback, rateLimiter);
+}
+
+QtSignalForwarder::Connection QtSignalForwarder::bindThrottled(QObject* sender, const char* signal, QObject* context,
+	const QtMetacallAdapter& callback, int interval, int edges
+)
+{
+	if (!(edges & (LeadingEdge | TrailingEdge))) {
+		qWarning() << "Throttled binding for" << signal+1 << "does not specify any edges";
+		return Connection();
+	}
+	QSharedPointer<RateLimiter> rateLimiter(new RateLimiter);
+	rateLimiter->interval = qMax(0, interval);
+	rateLimiter->edges = edges;
+	return bindRateLimited(sender, signal, context, callback, rateLimiter);
+}
+
+QtSignalForwarder::Connection QtSignalForwarder::bindRateLimited(QObject* sender, const char* signal, QObject* context,
+	const QtMetacallAdapter& callback, const QSharedPointer<RateLimiter>& rateLimiter
+)
+{
+	int signalIndex = qtObjectSignalIndex(sender, signal);
+	if (signalIndex < 0) {
+		qWarning() << "No such signal" << signal << "for" << sender;
+		return Connection();
+	}
+
+	const SignalDescriptor* descriptor = signalDescriptor(sender->metaObject(), signalIndex);
+	if (!checkTypeMatch(callback, descriptor->paramTypes, descriptor->paramCount)) {
+		qWarning() << "Sender and receiver types do not match for" << signal+1;
+		return Connection();
+	}
+
+	// only the arguments which the callback takes are kept.  Their types
+	// match the callback's and so are known to be registered.
+	int receiverArgTypes[QTMETACALL_MAX_ARGS] = {-1};
+	rateLimiter->argCount = callback.getArgTypes(receiverArgTypes);
+	rateLimiter->args.resize(rateLimiter->argCount);
+
+	int bindingId = bindSignal(sender, descriptor, context, callback);
+	if (bindingId < 0) {
+		return Connection();
+	}
+	Connection connection(this, bindingId, m_signalBindings.at(bindingId).generation);
+	rateLimiter->wheel = currentTimerWheel();
+	rateLimiter->expiry = QtMetacallAdapter::fromImpl<RateLimitExpiry>(connection);
+	m_signalBindings[bindingId].ensureExtras().rateLimiter = rateLimiter;
+	return connection;
+}
+
+void QtSignalForwarder::rateLimitSignal(int bindingId, const SignalDescriptor* signal, void** arguments)
+{
+	const Binding& binding = m_signalBindings.at(bindingId);
+	RateLimiter* rateLimiter = binding.rateLimiter();
+
+	if (!rateLimiter->debounce && !rateLimiter->isTimerActive() && (rateLimiter->edges & LeadingEdge)) {
+		// first emission after a quiet interval
+		startRateLimitTimer(rateLimiter);
+		invokeBinding(binding, signal, arguments);
+		return;
+	}
+
+	if (rateLimiter->debounce || (rateLimiter->edges & TrailingEdge)) {
+		// the stored arguments are overwritten in place, so nothing
+		// accumulates however often the signal is emitted
+		for (int i=0; i < rateLimiter->argCount; i++) {
+			int type = signal->paramTypes[i];
+			if (type == QMetaType::QVariant) {
+				rateLimiter->args[i] = *reinterpret_cast<const QVariant*>(arguments[i+1]);
+			} else {
+				rateLimiter->args[i] = QVariant(type, arguments[i+1]);
+			}
+		}
+		rateLimiter->hasPendingCall = true;
+	}
+
+	if (rateLimiter->debounce || !rateLimiter->isTimerActive()) {
+		startRateLimitTimer(rateLimiter);
+	}
+}
+
+void QtSignalForwarder::startRateLimitTimer(RateLimiter* rateLimiter)
+{
+	rateLimiter->deadline = rateLimiter->wheel->now() + rateLimiter->interval;
+	if (!rateLimiter->isTimerActive()) {
+		rateLimiter->startTimer(rateLimiter->interval);
+	}
+	// otherwise the timer is moved to the new deadline when it expires
+}
+
+void QtSignalForwarder::rateLimitExpired(const Connection& connection)
+{
+	QtSignalForwarder* proxy = connection.m_proxy.data();
+	if (!proxy) {
+		return;
+	}
+	int bindingId = proxy->findSignalBinding(connection);
+	if (bindingId >= 0) {
+		proxy->invokeRateLimited(bindingId);
+	}
+}
+
+void QtSignalForwarder::invokeRateLimited(int bindingId)
+{
+	const Binding& binding = m_signalBindings.at(bindingId);
+	if (binding.isContextDestroyed()) {
+		removeSignalBindingAndUnbindSender(bindingId);
+		return;
+	}
+
+	// the references keep the callback and arguments alive if
+	// the callback removes the binding or emits the signal again
+	QSharedPointer<RateLimiter> rateLimiter = binding.extras->rateLimiter;
+	qint64 remaining = rateLimiter->deadline - rateLimiter->wheel->now();
+	if (remaining > 0) {
+		// the interval was extended by later emissions
+		rateLimiter->startTimer(int(remaining));
+		return;
+	}
+
+	const SignalDescriptor* signal = signalConnection(binding.connectionId).signal;
+	QVector<QVariant> args = rateLimiter->args;
+
+	if (rateLimiter->hasPendingCall && !rateLimiter->debounce) {
+		// keep throttling emissions until an interval passes
+		// without any
+		startRateLimitTimer(rateLimiter.data());
+	}
+	if (!rateLimiter->hasPendingCall) {
+		return;
+	}
+	rateLimiter->hasPendingCall = false;
+
+	QGenericArgument genericArgs[MAX_SIGNAL_ARGS];
+	for (int i=0; i < rateLimiter->argCount; i++) {
+		const char* typeName = signal->paramTypeNames.at(i).constData();
+		if (signal->paramTypes[i] == QMetaType::QVariant) {
+			genericArgs[i] = QGenericArgument(typeName, &args.at(i));
+		} else {
+			genericArgs[i] = QGenericArgument(typeName, args.at(i).constData());
+		}
+	}
+	++m_dispatchDepth;
+	binding.callback.invoke(genericArgs, rateLimiter->argCount);
+	endDispatch();
+}
+
+int QtSignalForwarder::bindSignal(QObject* sender, const SignalDescriptor* descriptor, QObject* context,
+	const QtMetacallAdapter& callback
+)
+{
+	int signalIndex = descriptor->signalIndex;
+
+	// all bindings for a given (sender, signal) pair share one Qt connection
+	int connectionId = findSignalConnection(sender, signalIndex);
+	if (connectionId < 0) {
+		connectionId = m_connectionSlots.alloc();
+		if (m_signalConnections.count() < m_connectionSlots.capacity()) {
+			m_signalConnections.resize(m_connectionSlots.capacity());
+		}
+
+		int page = connectionId / CONNECTIONS_PER_PAGE;
+		while (m_extraPages.count() < page) {
+			m_extraPages.append(new MethodIdPage(this, m_pageConnectionCounts.count() * CONNECTIONS_PER_PAGE));
+			m_pageConnectionCounts.append(0);
+		}
+		int methodId = BINDING_METHOD_MIN_ID + connectionId % CONNECTIONS_PER_PAGE;
+
+		// we use Qt::DirectConnection here, so the callback will always be invoked on the same
+		// thread that the signal was delivered.  This ensures that we can rely on the object
+		// still existing in the qt_metacall() implementation.  This also means that we don't
+		// retain any QObject* pointers in the internal maps once the destroyed(QObject*) signal
+		// has been emitted.
+		//
+		// If the binding's callback uses QtCallback, that will use a queued connection if the receiver
+		// actually lives in a different thread.
+		//
+		if (!isDestroyedSignal(signalIndex) &&
+		    !QMetaObject::connect(sender, signalIndex, pageReceiver(page), methodId, Qt::DirectConnection, 0)) {
+			qWarning() << "Unable to connect signal" << signalIndex << "for" << sender;
+			m_connectionSlots.release(connectionId);
+			return -1;
+		}
+		++m_pageConnectionCounts[page];
+
+		SignalConnection& connection = m_signalConnections[connectionId];
+		connection.sender = sender;
+		connection.signal = descriptor;
+
+		// listen for the sender's destruction to remove all of its bindings
+		setupDestroyNotify(sender);
+		m_senderConnectionIds.insertMulti(sender, connectionId);
+	}
+
+	int bindingId = m_bindingSlots.alloc();
+	if (m_signalBindings.count() < m_bindingSlots.capacity()) {
+		m_signalBindings.resize(m_bindingSlots.capacity());
+	}
+	Binding& binding = m_signalBindings[bindingId];
+	binding.connectionId = connectionId;
+	binding.callback = callback;
+	binding.generation = ++m_lastGeneration;
+
+	m_signalConnections[connectionId].bindingIds.append(bindingId);
+
+	if (context && m_contextTracking == LazyContextTracking) {
+		BindingExtras& extras = binding.ensureExtras();
+		extras.hasContextGuard = true;
+		extras.contextGuard = context;
+		++m_lazyContextBindingCount;
+
+		// reclaim bindings whose contexts have been destroyed at a
+		// faster rate than new ones are added
+		sweepContexts(CONTEXT_SWEEP_STEP);
+	} else if (context) {
+		binding.context = context;
+		setupDestroyNotify(context);
+		m_contextBindingIds.insertMulti(context, bindingId);
+	}
+
+	return bindingId;
+}
+
+bool QtSignalForwarder::bind(QObject* sender, QEvent::Type event, const QtMetacallAdapter& callback, EventFilterFunc filter)
+{
+	if (!checkTypeMatch(callback, 0, 0)) {
+		qWarning() << "Callback does not take 0 arguments";
+		return false;
+	}
+
+	addEventBinding(EventBinding(sender, event, callback, filter));
+	return true;
+}
+
+bool QtSignalForwarder::bindEventFilter(QObject* sender, QEvent::Type event, const EventHandler& handler)
+{
+	if (!handler) {
+		qWarning() << "Event handler is empty";
+		return false;
+	}
+
+	EventBinding binding(sender, event);
+	binding.target->handler = handler;
+	addEventBinding(binding);
+	return true;
+}
+
+bool QtSignalForwarder::bindCoalesced(QObject* sender, QEvent::Type event, const EventCallback& callback, int interval)
+{
+	if (!callback) {
+		qWarning() << "Event callback is empty";
+		return false;
+	}
+
+	EventBinding binding(sender, event);
+	binding.coalesced = QSharedPointer<CoalescedEvent>(new CoalescedEvent);
+	binding.coalesced->sender = sender;
+	binding.coalesced->interval = qMax(0, interval);
+	binding.coalesced->callback = callback;
+	addEventBinding(binding);
+	return true;
+}
+
+void QtSignalForwarder::coalesceEvent(const EventBinding& binding, QEvent* event)
+{
+	CoalescedEvent* coalesced = binding.coalesced.data();
+	delete coalesced->pendingEvent;
+	coalesced->pendingEvent = copyEvent(event);
+	if (!coalesced->timer.isActive()) {
+		coalesced->timer.start(coalesced->interval, this);
+		m_pendingCoalescedEvents.insert(coalesced->timer.timerId(), binding.coalesced);
+	}
+}
+
+void QtSignalForwarder::releaseEventBinding(const EventBinding& binding)
+{
+	if (binding.coalesced && binding.coalesced->timer.isActive()) {
+		m_pendingCoalescedEvents.remove(binding.coalesced->timer.timerId());
+		binding.coalesced->timer.stop();
+	}
+}
+
+void QtSignalForwarder::timerEvent(QTimerEvent* event)
+{
+	QHash<int,QSharedPointer<CoalescedEvent> >::iterator iter = m_pendingCoalescedEvents.find(event->timerId());
+	if (iter == m_pendingCoalescedEvents.end()) {
+		QObject::timerEvent(event);
+		return;
+	}
+
+	// the reference keeps the binding's state alive if the
+	// callback removes the binding
+	QSharedPointer<CoalescedEvent> coalesced = *iter;
+	m_pendingCoalescedEvents.erase(iter);
+	coalesced->timer.stop();
+
+	QScopedPointer<QEvent> pendingEvent(coalesced->pendingEvent);
+	coalesced->pendingEvent = 0;
+
+	++m_dispatchDepth;
+	coalesced->callback(coalesced->sender, pendingEvent.data());
+	endDispatch();
+}
+
+void QtSignalForwarder::addEventBinding(const EventBinding& binding)
+{
+	QObject* sender = binding.sender;
+	setupDestroyNotify(sender);
+
+	EventWatch& watch = m_eventBindings[sender];
+	if (watch.bindings.isEmpty()) {
+		sender->installEventFilter(this);
+	}
+	watch.bindings.append(binding);
+	++m_eventBindingCount;
+
+	quint64 oldMask = watch.eventMask;
+	watch.eventMask |= eventTypeBit(binding.eventType);
+	addEventTypes(watch.eventMask & ~oldMask);
+}
+
+void QtSignalForwarder::addEventTypes(quint64 mask)
+{
+	for (int bit=0; mask; bit++, mask >>= 1) {
+		if ((mask & 1) && m_eventTypeCounts[bit]++ == 0) {
+			m_eventMask |= Q_UINT64_C(1) << bit;
+		}
+	}
+}
+
+void QtSignalForwarder::removeEventTypes(quint64 mask)
+{
+	for (int bit=0; mask; bit++, mask >>= 1) {
+		if ((mask & 1) && --m_eventTypeCounts[bit] == 0) {
+			m_eventMask &= ~(Q_UINT64_C(1) << bit);
+		}
+	}
+}
+
+void QtSignalForwarder::removeEventWatch(QObject* watched)
+{
+	QHash<QObject*,EventWatch>::iterator iter = m_eventBindings.find(watched);
+	if (iter != m_eventBindings.end()) {
+		for (int i=0; i < iter->bindings.count(); i++) {
+			releaseEventBinding(iter->bindings.at(i));
+		}
+		removeEventTypes(iter->eventMask);
+		m_eventBindingCount -= iter->bindings.count();
+		m_eventBindings.erase(iter);
+	}
+}
+
+void QtSignalForwarder::unbind(QObject* sender, const char* signal)
+{
+	int signalIndex = qtObjectSignalIndex(sender, signal);
+	int connectionId = findSignalConnection(sender, signalIndex);
+	if (connectionId >= 0) {
+		removeSignalConnection(connectionId);
+	}
+
+	if (!isConnected(sender)) {
+		// disconnect destruction notifications
+		unbindSender(sender);
+	}
+}
+
+void QtSignalForwarder::unbind(QObject* sender, QEvent::Type event)
+{
+	QHash<QObject*,EventWatch>::iterator iter = m_eventBindings.find(sender);
+	if (iter != m_eventBindings.end()) {
+		EventWatch& watch = *iter;
+		QVarLengthArray<EventBinding,2> remaining;
+		quint64 remainingMask = 0;
+		for (int i=0; i < watch.bindings.count(); i++) {
+			const EventBinding& binding = watch.bindings.at(i);
+			if (binding.eventType != event) {
+				remaining.append(binding);
+				remainingMask |= eventTypeBit(binding.eventType);
+			}
+		}
+		if (remaining.isEmpty()) {
+			removeEventWatch(sender);
+		} else {
+			for (int i=0; i < watch.bindings.count(); i++) {
+				if (watch.bindings.at(i).eventType == event) {
+					releaseEventBinding(watch.bindings.at(i));
+				}
+			}
+			m_eventBindingCount -= watch.bindings.count() - remaining.count();
+			removeEventTypes(watch.eventMask & ~remainingMask);
+			watch.eventMask = remainingMask;
+			watch.bindings = remaining;
+		}
+	}
+	if (!isConnected(sender)) {
+		// disconnect destruction notifications
+		unbindSender(sender);
+	}
+}
+
+void QtSignalForwarder::unbind(QObject* sender)
+{
+	// bindings using LazyContextTracking are not indexed by context,
+	// so they have to be found by a scan.  This is only done here rather
+	// than in unbindSender(), which is used each time a sender loses its
+	// last binding.
+	for (int i=0; m_lazyContextBindingCount > 0 && i < m_signalBindings.count(); i++) {
+		const Binding& binding = m_signalBindings.at(i);
+		if (binding.connectionId >= 0 && binding.hasContextGuard() &&
+		    binding.extras->contextGuard.data() == sender) {
+			// the binding's own sender may not be bound to anything else,
+			// in which case it no longer needs to be watched
+			removeSignalBindingAndUnbindSender(i);
+		}
+	}
+	unbindSender(sender);
+}
+
+void QtSignalForwarder::unbindSender(QObject* sender)
+{
+	{
+		QHash<QObject*,int>::iterator iter = m_senderConnectionIds.find(sender);
+		while (iter != m_senderConnectionIds.end() && iter.key() == sender) {
+			disconnectSignalConnection(*iter);
+			releaseSignalConnection(*iter);
+			iter = m_senderConnectionIds.erase(iter);
+		}
+	}
+	removeEventWatch(sender);
+
+	sender->removeEventFilter(this);
+
+	{
+		QHash<QObject*,int>::iterator iter = m_contextBindingIds.find(sender);
+		while (iter != m_contextBindingIds.end() && iter.key() == sender) {
+			int bindingId = *iter;
+			iter = m_contextBindingIds.erase(iter);
+			m_signalBindings[bindingId].context = 0;
+			removeSignalBinding(bindingId);
+		}
+	}
+
+	if (m_destructionRegistry) {
+		m_destructionRegistry->unwatch(sender, this);
+	}
+	squeezeIfSparse();
+}
+
+void QtSignalForwarder::unbind(const Connection& connection)
+{
+	int bindingId = findSignalBinding(connection);
+	if (bindingId < 0) {
+		return;
+	}
+
+	removeSignalBindingAndUnbindSender(bindingId);
+}
+
+void QtSignalForwarder::removeSignalBindingAndUnbindSender(int bindingId)
+{
+	int connectionId = m_signalBindings.at(bindingId).connectionId;
+	QObject* sender = signalConnection(connectionId).sender;
+	removeSignalBinding(bindingId);
+
+	// if that was the last binding for the signal, check whether
+	// the proxy still needs to listen for the sender's destruction
+	if (signalConnection(connectionId).sender != sender && !isConnected(sender)) {
+		unbindSender(sender);
+	}
+}
+
+void QtSignalForwarder::sweepContexts()
+{
+	sweepContexts(m_signalBindings.count());
+}
+
+void QtSignalForwarder::sweepContexts(int maxBindings)
+{
+	int bindingCount = m_signalBindings.count();
+	maxBindings = qMin(maxBindings, bindingCount);
+	for (int i=0; i < maxBindings; i++) {
+		if (m_sweepCursor >= bindingCount) {
+			m_sweepCursor = 0;
+		}
+		int bindingId = m_sweepCursor++;
+		const Binding& binding = m_signalBindings.at(bindingId);
+		if (binding.connectionId >= 0 && binding.isContextDestroyed()) {
+			// this never shrinks the binding array, so bindingCount
+			// remains valid
+			removeSignalBindingAndUnbindSender(bindingId);
+		}
+	}
+}
+
+void QtSignalForwarder::unbindAll(const Connection* connections, int count)
+{
+	// release the bindings first and then update each affected connection
+	// and sender once, rather than once per binding
+	QVarLengthArray<int,64> connectionIds;
+	for (int i=0; i < count; i++) {
+		Q_ASSERT(connections[i].m_proxy.data() == this);
+		int bindingId = findSignalBinding(connections[i]);
+		if (bindingId >= 0) {
+			connectionIds.append(m_signalBindings.at(bindingId).connectionId);
+			releaseSignalBinding(bindingId);
+		}
+	}
+	std::sort(connectionIds.data(), connectionIds.data() + connectionIds.count());
+	int* connectionIdsEnd = std::unique(connectionIds.data(), connectionIds.data() + connectionIds.count());
+
+	QVarLengthArray<QObject*,64> senders;
+	for (int* iter = connectionIds.data(); iter != connectionIdsEnd; ++iter) {
+		int connectionId = *iter;
+		SignalConnection& connection = m_signalConnections[connectionId];
+
+		// remove the released bindings from the connection's list
+		int remaining = 0;
+		for (int i=0; i < connection.bindingIds.count(); i++) {
+			int bindingId = connection.bindingIds.at(i);
+			if (m_signalBindings.at(bindingId).connectionId == connectionId) {
+				connection.bindingIds[remaining++] = bindingId;
+			}
+		}
+		connection.bindingIds.resize(remaining);
+
+		if (remaining == 0) {
+			senders.append(connection.sender);
+			removeSignalConnection(connectionId);
+		}
+	}
+
+	// stop listening for the destruction of senders which
+	// no longer have any bindings
+	std::sort(senders.data(), senders.data() + senders.count());
+	QObject** sendersEnd = std::unique(senders.data(), senders.data() + senders.count());
+	for (QObject** iter = senders.data(); iter != sendersEnd; ++iter) {
+		if (!isConnected(*iter)) {
+			unbindSender(*iter);
+		}
+	}
+	squeezeIfSparse();
+}
+
+int QtSignalForwarder::findSignalBinding(const Connection& connection) const
+{
+	if (connection.m_proxy.data() != this ||
+	    connection.m_bindingId < 0 || connection.m_bindingId >= m_signalBindings.count()) {
+		return -1;
+	}
+	const Binding& binding = m_signalBindings.at(connection.m_bindingId);
+	if (binding.connectionId < 0 || binding.generation != connection.m_generation) {
+		return -1;
+	}
+	return connection.m_bindingId;
+}
+
+bool QtSignalForwarder::Connection::isConnected() const
+{
+	QtSignalForwarder* proxy = m_proxy.data();
+	return proxy && proxy->isConnected(*this);
+}
 
-// dummy function for use with the sentinel callback for when
-// an object is destroyed. It should never actually be called.
-void destroyBindingFunc()
+void QtSignalForwarder::Connection::disconnect()
 {
-	Q_ASSERT(false);
+	QtSignalForwarder* proxy = m_proxy.data();
+	if (proxy) {
+		proxy->unbind(*this);
+	}
 }
-QtMetacallAdapter QtSignalForwarder::s_senderDestroyedCallback(destroyBindingFunc);
-	
-// per-thread arrays of shared proxies used by the static connect() method
-Q_GLOBAL_STATIC(QThreadStorage<QVector<QSharedPointer<QtSignalForwarder> > >, sharedProxyList)
 
-int qtObjectSignalIndex(const QObject* object, const char* signal)
+QtSignalForwarder::Connection QtSignalForwarder::ConnectionGroup::connect(QObject* sender, const char* signal,
+	QObject* context, const QtMetacallAdapter& callback
+)
 {
-	const QMetaObject* metaObject = object->metaObject();
-	int signalIndex = metaObject->indexOfMethod(signal + 1);
-	if (signalIndex < 0) {
-		QByteArray normalizedSignature = QMetaObject::normalizedSignature(signal + 1);
-		signalIndex = metaObject->indexOfMethod(normalizedSignature.constData());
-	}
-	return signalIndex;
+	Connection connection = QtSignalForwarder::connect(sender, signal, context, callback);
+	add(connection);
+	return connection;
 }
 
-QtSignalForwarder::QtSignalForwarder(QObject* parent)
-	: QObject(parent)
+void QtSignalForwarder::ConnectionGroup::add(const Connection& connection)
 {
+	if (connection) {
+		m_connections.append(connection);
+	}
 }
 
-QtSignalForwarder::~QtSignalForwarder()
+bool QtSignalForwarder::ConnectionGroup::proxyLessThan(const Connection& a, const Connection& b)
 {
+	return a.m_proxy.data() < b.m_proxy.data();
 }
 
-bool QtSignalForwarder::checkTypeMatch(const QtMetacallAdapter& callback, const QList<QByteArray>& paramTypes)
+void QtSignalForwarder::ConnectionGroup::disconnectAll()
 {
-	int receiverArgTypes[QTMETACALL_MAX_ARGS] = {-1};
-	int receiverArgCount = callback.getArgTypes(receiverArgTypes);
+	QVector<Connection> connections;
+	qSwap(connections, m_connections);
 
-	for (int i=0; i < receiverArgCount; i++) {
-		if (i >= paramTypes.count()) {
-			qWarning() << "Missing argument" << i << ": "
-			  << "Receiver expects" << QLatin1String(QMetaType::typeName(receiverArgTypes[i]));
-			return false;
+	// group the bindings by proxy so that each proxy
+	// can remove its share in one pass
+	std::sort(connections.begin(), connections.end(), proxyLessThan);
+	int start = 0;
+	while (start < connections.count()) {
+		QtSignalForwarder* proxy = connections.at(start).m_proxy.data();
+		int end = start + 1;
+		while (end < connections.count() && connections.at(end).m_proxy.data() == proxy) {
+			++end;
 		}
-		int type = QMetaType::type(paramTypes.at(i).data());
-		if (type != receiverArgTypes[i]) {
-			qWarning() << "Type mismatch for argument" << i << ": "
-			  << "Signal sends" << QLatin1String(QMetaType::typeName(type))
-			  << "receiver expects" << QLatin1String(QMetaType::typeName(receiverArgTypes[i]));
-			return false;
+		if (proxy) {
+			proxy->unbindAll(connections.constData() + start, end - start);
 		}
+		start = end;
 	}
+}
 
-	return true;
+void QtSignalForwarder::removeSignalConnection(int connectionId)
+{
+	QObject* sender = signalConnection(connectionId).sender;
+
+	disconnectSignalConnection(connectionId);
+	releaseSignalConnection(connectionId);
+	m_senderConnectionIds.remove(sender, connectionId);
 }
 
-void QtSignalForwarder::setupDestroyNotify(QObject* sender)
+void QtSignalForwarder::disconnectSignalConnection(int connectionId)
 {
-	if (!m_senderSignalBindingIds.contains(sender)) {
-		bind(sender, SIGNAL(destroyed(QObject*)), s_senderDestroyedCallback);
+	const SignalConnection& connection = signalConnection(connectionId);
+	if (isDestroyedSignal(connection.signal->signalIndex)) {
+		// see objectDestroyed()
+		return;
 	}
+	QMetaObject::disconnect(connection.sender, connection.signal->signalIndex,
+	  pageReceiver(connectionId / CONNECTIONS_PER_PAGE),
+	  BINDING_METHOD_MIN_ID + connectionId % CONNECTIONS_PER_PAGE);
 }
 
-bool QtSignalForwarder::bind(QObject* sender, const char* signal, QObject *context,
-	const QtMetacallAdapter& callback
-)
+void QtSignalForwarder::releaseSignalConnection(int connectionId)
 {
-	int signalIndex = qtObjectSignalIndex(sender, signal);
-	if (signalIndex < 0) {
-		qWarning() << "No such signal" << signal << "for" << sender;
-		return false;
+	SignalConnection& connection = m_signalConnections[connectionId];
+	Q_ASSERT(connection.sender);
+
+	for (int i=0; i < connection.bindingIds.count(); i++) {
+		releaseSignalBinding(connection.bindingIds.at(i));
 	}
+	connection = SignalConnection();
+	m_connectionSlots.release(connectionId);
+	--m_pageConnectionCounts[connectionId / CONNECTIONS_PER_PAGE];
+}
 
-	Binding binding(sender, signalIndex, context, callback);
-	binding.paramTypes = sender->metaObject()->method(signalIndex).parameterTypes();
+QObject* QtSignalForwarder::pageReceiver(int page) const
+{
+	return page == 0 ? const_cast<QtSignalForwarder*>(this) : static_cast<QObject*>(m_extraPages.at(page - 1));
+}
 
-	if (!checkTypeMatch(callback, binding.paramTypes)) {
-		qWarning() << "Sender and receiver types do not match for" << signal+1;
-		return false;
+void QtSignalForwarder::trimPages()
+{
+	int pageCount = m_extraPages.count();
+	while (pageCount > 0 && m_pageConnectionCounts.at(pageCount) == 0) {
+		--pageCount;
 	}
-
-	if (!canAddSignalBindings()) {
-		qWarning() << "Limit of bindings per proxy has been reached";
-		return false;
+	if (pageCount == m_extraPages.count()) {
+		return;
 	}
 
-	if (m_freeSignalBindingIds.isEmpty()) {
-		m_freeSignalBindingIds << BINDING_METHOD_MIN_ID + m_signalBindings.count();
+	for (int i = pageCount; i < m_extraPages.count(); i++) {
+		delete m_extraPages.at(i);
 	}
-	int bindingId = m_freeSignalBindingIds.takeFirst();
-	Q_ASSERT(!m_signalBindings.contains(bindingId));
+	m_extraPages.resize(pageCount);
+	m_pageConnectionCounts.resize(pageCount + 1);
 
-	// we use Qt::DirectConnection here, so the callback will always be invoked on the same
-	// thread that the signal was delivered.  This ensures that we can rely on the object
-	// still existing in the qt_metacall() implementation.  This also means that we don't
-	// retain any QObject* pointers in the internal maps once the destroyed(QObject*) signal
-	// has been emitted.
-	//
-	// If the binding's callback uses QtCallback, that will use a queued connection if the receiver
-	// actually lives in a different thread.
-	//
-	if (!QMetaObject::connect(sender, signalIndex, this, bindingId, Qt::DirectConnection, 0)) {
-		qWarning() << "Unable to connect signal" << signal << "for" << sender;
-		return false;
-	}
+	// the connection slots for the removed pages are all free
+	m_connectionSlots.squeeze();
+	m_signalConnections.resize(m_connectionSlots.capacity());
+}
+
+void QtSignalForwarder::removeSignalBinding(int bindingId)
+{
+	int connectionId = m_signalBindings.at(bindingId).connectionId;
+	Q_ASSERT(connectionId >= 0);
+	releaseSignalBinding(bindingId);
 
-	m_signalBindings.insert(bindingId, binding);
+	QVarLengthArray<int,2>& bindingIds = m_signalConnections[connectionId].bindingIds;
+	for (int i=0; i < bindingIds.count(); i++) {
+		if (bindingIds.at(i) == bindingId) {
+			for (int k=i+1; k < bindingIds.count(); k++) {
+				bindingIds[k-1] = bindingIds[k];
+			}
+			bindingIds.removeLast();
+			break;
+		}
+	}
+	if (bindingIds.isEmpty()) {
+		removeSignalConnection(connectionId);
+	}
+}
 
-	if (callback != s_senderDestroyedCallback) {
-		// listen for destroyed(QObject*) signal to remove
-		// all bindings.  setupDestroyNotify() in turn calls bind()
-		// with s_senderDestroyedCallback as the callback
-		setupDestroyNotify(sender);
+void QtSignalForwarder::releaseSignalBinding(int bindingId)
+{
+	Binding& binding = m_signalBindings[bindingId];
+	QObject* context = binding.context;
+	binding.connectionId = -1;
+	binding.context = 0;
+	if (binding.hasContextGuard()) {
+		binding.extras->hasContextGuard = false;
+		binding.extras->contextGuard = 0;
+		--m_lazyContextBindingCount;
+	}
+	if (RateLimiter* rateLimiter = binding.rateLimiter()) {
+		rateLimiter->wheel->cancel(rateLimiter->timerId, rateLimiter->timerGeneration);
+	}
+	if (m_dispatchDepth > 0) {
+		// the binding's callback may be running
+		m_pendingBindingReleases.append(bindingId);
+	} else {
+		binding.callback = QtMetacallAdapter();
+		binding.extras.reset();
+		m_bindingSlots.release(bindingId);
 	}
-	
-	m_senderSignalBindingIds.insertMulti(sender, bindingId);
 
 	if (context) {
-		setupDestroyNotify(context);
-		m_contextBindingIds.insertMulti(context, bindingId);
+		m_contextBindingIds.remove(context, bindingId);
+		releaseDestroyNotify(context);
 	}
+}
 
-	return true;
+void QtSignalForwarder::releasePendingBindings()
+{
+	// destroying a callback may remove further bindings
+	QVector<int> bindingIds;
+	qSwap(bindingIds, m_pendingBindingReleases);
+	for (int i=0; i < bindingIds.count(); i++) {
+		Binding& binding = m_signalBindings[bindingIds.at(i)];
+		binding.callback = QtMetacallAdapter();
+		binding.extras.reset();
+		m_bindingSlots.release(bindingIds.at(i));
+	}
 }
 
-bool QtSignalForwarder::bind(QObject* sender, QEvent::Type event, const QtMetacallAdapter& callback, EventFilterFunc filter)
+void QtSignalForwarder::endDispatch()
 {
-	if (!checkTypeMatch(callback, QList<QByteArray>())) {
-		qWarning() << "Callback does not take 0 arguments";
-		return false;
+	--m_dispatchDepth;
+	if (m_dispatchDepth == 0 && !m_pendingBindingReleases.isEmpty()) {
+		releasePendingBindings();
 	}
+}
 
-	setupDestroyNotify(sender);
-	sender->installEventFilter(this);
+int QtSignalForwarder::findSignalConnection(QObject* sender, int signalIndex) const
+{
+	QHash<QObject*,int>::const_iterator iter = m_senderConnectionIds.find(sender);
+	for (; iter != m_senderConnectionIds.end() && iter.key() == sender; ++iter) {
+		if (signalConnection(*iter).signal->signalIndex == signalIndex) {
+			return *iter;
+		}
+	}
+	return -1;
+}
 
-	EventBinding binding(sender, event, callback, filter);
-	m_eventBindings.insertMulti(sender, binding);
+const QtSignalForwarder::SignalConnection& QtSignalForwarder::signalConnection(int connectionId) const
+{
+	return m_signalConnections.at(connectionId);
+}
 
-	return true;
+void QtSignalForwarder::reserveSignalBindings(int count)
+{
+	m_connectionSlots.reserve(count);
+	m_signalConnections.reserve(m_connectionSlots.capacity());
+	m_bindingSlots.reserve(count);
+	m_signalBindings.reserve(m_bindingSlots.capacity());
+	m_senderConnectionIds.reserve(m_senderConnectionIds.size() + count);
 }
 
-void QtSignalForwarder::unbind(QObject* sender, const char* signal)
+int QtSignalForwarder::SlotMap::alloc()
 {
-	int signalIndex = qtObjectSignalIndex(sender, signal);
-	QHash<QObject*,int>::iterator iter = m_senderSignalBindingIds.find(sender);
-	while (iter != m_senderSignalBindingIds.end() && iter.key() == sender) {
-		Q_ASSERT(m_signalBindings.contains(*iter));
-		const Binding& binding = m_signalBindings.value(*iter);
-		if (binding.signalIndex == signalIndex) {
-			m_freeSignalBindingIds << *iter;
-			QObject* context = m_signalBindings.take(*iter).context;
-			m_contextBindingIds.remove(context, *iter);
-			iter = m_senderSignalBindingIds.erase(iter);
-		} else {
-			++iter;
+	int wordCount = m_freeSlots.count();
+	for (int word = m_firstFreeWord; word < wordCount; word++) {
+		quint32 freeSlots = m_freeSlots.at(word);
+		if (freeSlots) {
+			int bit = lowestSetBit(freeSlots);
+			m_freeSlots[word] = freeSlots & ~(1u << bit);
+			m_firstFreeWord = word;
+			++m_usedCount;
+			return word * SLOTS_PER_WORD + bit;
 		}
 	}
 
-	if (!isConnected(sender)) {
-		// disconnect destruction notifications
-		unbind(sender);
-	}
+	// all slots are in use, grow the map by one word's worth
+	// of slots and use the first one
+	m_firstFreeWord = wordCount;
+	m_freeSlots.append(~1u);
+	++m_usedCount;
+	return wordCount * SLOTS_PER_WORD;
 }
 
-void QtSignalForwarder::unbind(QObject* sender, QEvent::Type event)
+void QtSignalForwarder::SlotMap::release(int slot)
 {
-	QHash<QObject*,EventBinding>::iterator iter = m_eventBindings.find(sender);
-	while (iter != m_eventBindings.end() && iter.key() == sender) {
-		if (iter->eventType == event) {
-			iter = m_eventBindings.erase(iter);
-		} else {
-			++iter;
-		}
-	}
-	if (!isConnected(sender)) {
-		// disconnect destruction notifications
-		unbind(sender);
-	}
+	int word = slot / SLOTS_PER_WORD;
+	Q_ASSERT(!(m_freeSlots.at(word) & (1u << (slot % SLOTS_PER_WORD))));
+
+	m_freeSlots[word] |= 1u << (slot % SLOTS_PER_WORD);
+	m_firstFreeWord = qMin(m_firstFreeWord, word);
+	--m_usedCount;
 }
 
-void QtSignalForwarder::unbind(QObject* sender)
+void QtSignalForwarder::SlotMap::reserve(int count)
 {
-	{
-		QHash<QObject*,int>::iterator iter = m_senderSignalBindingIds.find(sender);
-		while (iter != m_senderSignalBindingIds.end() && iter.key() == sender) {
-			m_freeSignalBindingIds << *iter;
-			QObject* context = m_signalBindings.take(*iter).context;
-			m_contextBindingIds.remove(context, *iter);
-			iter = m_senderSignalBindingIds.erase(iter);
-		}
+	int wordCount = (m_usedCount + count + SLOTS_PER_WORD - 1) / SLOTS_PER_WORD;
+	m_freeSlots.reserve(wordCount);
+}
+
+void QtSignalForwarder::SlotMap::squeeze()
+{
+	int wordCount = m_freeSlots.count();
+	while (wordCount > 0 && m_freeSlots.at(wordCount - 1) == ~0u) {
+		--wordCount;
 	}
-	m_eventBindings.remove(sender);
+	m_freeSlots.resize(wordCount);
+	m_freeSlots.squeeze();
+	m_firstFreeWord = qMin(m_firstFreeWord, wordCount);
+}
 
-	sender->removeEventFilter(this);
-	disconnect(sender, 0, this, 0);
+int QtSignalForwarder::SlotMap::capacity() const
+{
+	return m_freeSlots.count() * SLOTS_PER_WORD;
+}
 
-	{
-		QHash<QObject*,int>::iterator iter = m_contextBindingIds.find(sender);
-		while (iter != m_contextBindingIds.end() && iter.key() == sender) {
-			m_freeSignalBindingIds << *iter;
-			int id = *iter;
-			Binding x = m_signalBindings.take(id);
-			m_senderSignalBindingIds.remove(x.sender, *iter);
-			iter = m_contextBindingIds.erase(iter);
-			QMetaObject::disconnect(x.sender, x.signalIndex, this, id);
-		}
+bool QtSignalForwarder::isIdle() const
+{
+	return m_connectionSlots.usedCount() == 0 && m_eventBindings.isEmpty() && m_dispatchDepth == 0;
+}
+
+// returns true if a hash table is large enough and sparse enough
+// to be worth shrinking.  The threshold leaves enough headroom that
+// alternately adding and removing bindings does not repeatedly resize
+// the table.
+template <class Hash>
+static bool isSparse(const Hash& hash)
+{
+	return hash.capacity() > MIN_SQUEEZE_CAPACITY && hash.size() * 4 < hash.capacity();
+}
+
+void QtSignalForwarder::squeezeIfSparse()
+{
+	if (m_dispatchDepth > 0) {
+		// avoid re-hashing tables which may be in the middle of
+		// being iterated over
+		return;
+	}
+	if (isSparse(m_senderConnectionIds)) {
+		m_senderConnectionIds.squeeze();
+	}
+	if (isSparse(m_contextBindingIds)) {
+		m_contextBindingIds.squeeze();
 	}
+	if (isSparse(m_eventBindings)) {
+		m_eventBindings.squeeze();
+	}
+	trimPages();
+}
+
+void QtSignalForwarder::compactStorage()
+{
+	sweepContexts();
 
+	m_senderConnectionIds.squeeze();
+	m_contextBindingIds.squeeze();
+	m_eventBindings.squeeze();
+
+	// free slots at the end of the connection and binding arrays
+	// can be released.  Handles which refer to released binding slots
+	// remain stale if the slots are used again later, as generation
+	// values are never re-used.
+	trimPages();
+	m_connectionSlots.squeeze();
+	m_signalConnections.resize(m_connectionSlots.capacity());
+	m_signalConnections.squeeze();
+	m_bindingSlots.squeeze();
+	m_signalBindings.resize(m_bindingSlots.capacity());
+	m_signalBindings.squeeze();
 }
 
-bool QtSignalForwarder::canAddSignalBindings() const
+void QtSignalForwarder::compact()
 {
-	return m_signalBindings.count() < MAX_BINDINGS_PER_PROXY;
+	SharedProxyPool& pool = sharedProxyPools()->localData();
+	for (int shard=0; shard < pool.shards.count(); shard++) {
+		QSharedPointer<QtSignalForwarder>& proxy = pool.shards[shard];
+		if (!proxy) {
+			continue;
+		}
+		// idle proxies are re-created if the shard is used again
+		if (proxy->isIdle()) {
+			proxy.clear();
+		} else if (proxy->m_dispatchDepth == 0) {
+			proxy->compactStorage();
+		}
+	}
 }
 
 QtSignalForwarder* QtSignalForwarder::sharedProxy(QObject* sender)
 {
-	Q_UNUSED(sender);
-
 	// We try to use a small number of shared proxy objects to minimize
 	// the overhead of each binding.
 	//
@@ -247,26 +2338,131 @@ QtSignalForwarder* QtSignalForwarder::sharedProxy(QObject* sender)
 	//
 	// - Some operations in QObject's internals are linear in the number of
 	//   connected senders, eg. sender(), senderSignalIndex()
-	// - There is a limit on the number of signal bindings for any given proxy
 	// - When using Qt::AutoConnection to connect the sender and receiver, the
 	//   delivery method depends on the sender/receiver threads
 	//
-	QVector<QSharedPointer<QtSignalForwarder> > &proxies = sharedProxyList()->localData();
-	if (proxies.isEmpty() || !proxies.last()->canAddSignalBindings()) {
-		QtSignalForwarder* newProxy = new QtSignalForwarder();
-		proxies << QSharedPointer<QtSignalForwarder>(newProxy);
+	// To balance these, senders are spread over a fixed number of proxies per thread
+	// by address, so all of a sender's bindings are held by the same proxy.
+	//
+	QSharedPointer<QtSignalForwarder>& proxy = sharedProxyForShard(sender);
+	if (!proxy) {
+		proxy = QSharedPointer<QtSignalForwarder>(new QtSignalForwarder());
 	}
-	return proxies.last().data();
+	return proxy.data();
+}
+
+void QtSignalForwarder::setSharedProxyCount(int count)
+{
+	Q_ASSERT(count > 0);
+	s_sharedProxyCount.fetchAndStoreOrdered(qMax(1, count));
+}
+
+int QtSignalForwarder::sharedProxyCount()
+{
+	return loadSharedProxyCount();
 }
 
-bool QtSignalForwarder::connect(QObject* sender, const char* signal, QObject *context, const QtMetacallAdapter& callback)
+QtSignalForwarder::Connection QtSignalForwarder::connect(QObject* sender, const char* signal, QObject *context, const QtMetacallAdapter& callback)
 {
 	return sharedProxy(sender)->bind(sender, signal, context, callback);
 }
 
+int QtSignalForwarder::connectBatch(const QVector<QObject*>& senders, const char* signal, QObject* context,
+	const QVector<QtMetacallAdapter>& callbacks
+)
+{
+	Q_ASSERT(senders.count() == callbacks.count());
+
+	// the signal is resolved once per sender class before anything is
+	// bound, so that a batch for a signal which does not exist fails
+	// with a single warning
+	QHash<const QMetaObject*,const SignalDescriptor*> descriptors;
+	const QMetaObject* metaObject = 0;
+	bool anyResolved = false;
+	for (int i=0; i < senders.count(); i++) {
+		QObject* sender = senders.at(i);
+		if (sender->metaObject() == metaObject || descriptors.contains(sender->metaObject())) {
+			continue;
+		}
+		metaObject = sender->metaObject();
+		int signalIndex = qtObjectSignalIndex(sender, signal);
+		const SignalDescriptor* descriptor = signalIndex >= 0 ? signalDescriptor(metaObject, signalIndex) : 0;
+		if (!descriptor) {
+			qWarning() << "No such signal" << signal << "for" << metaObject->className();
+		}
+		descriptors.insert(metaObject, descriptor);
+		anyResolved = anyResolved || descriptor;
+	}
+	if (!anyResolved) {
+		return 0;
+	}
+
+	// the callback types are checked once per distinct set of argument
+	// types for each signal
+	metaObject = 0;
+	const SignalDescriptor* descriptor = 0;
+	int checkedArgTypes[QTMETACALL_MAX_ARGS];
+	int checkedArgCount = -1;
+	bool checkedTypesMatch = false;
+
+	// senders are spread over the shared proxies, so space is reserved
+	// in each proxy for its expected share of the batch the first time
+	// that it is used
+	int expectedPerProxy = senders.count() / sharedProxyCount() + 1;
+	QSet<QtSignalForwarder*> reservedProxies;
+
+	int connected = 0;
+
+	for (int i=0; i < senders.count(); i++) {
+		QObject* sender = senders.at(i);
+		const QtMetacallAdapter& callback = callbacks.at(i);
+
+		if (sender->metaObject() != metaObject) {
+			metaObject = sender->metaObject();
+			const SignalDescriptor* senderDescriptor = descriptors.value(metaObject);
+			if (senderDescriptor != descriptor) {
+				descriptor = senderDescriptor;
+				checkedArgCount = -1;
+			}
+		}
+		if (!descriptor) {
+			continue;
+		}
+
+		int argTypes[QTMETACALL_MAX_ARGS];
+		int argCount = callback.getArgTypes(argTypes);
+		if (argCount != checkedArgCount ||
+		    !std::equal(argTypes, argTypes + argCount, checkedArgTypes)) {
+			checkedTypesMatch = checkTypeMatch(callback, descriptor->paramTypes, descriptor->paramCount);
+			if (!checkedTypesMatch) {
+				qWarning() << "Sender and receiver types do not match for" << signal+1;
+			}
+			std::copy(argTypes, argTypes + argCount, checkedArgTypes);
+			checkedArgCount = argCount;
+		}
+		if (!checkedTypesMatch) {
+			continue;
+		}
+
+		QtSignalForwarder* proxy = sharedProxy(sender);
+		if (!reservedProxies.contains(proxy)) {
+			reservedProxies.insert(proxy);
+			proxy->reserveSignalBindings(expectedPerProxy);
+		}
+
+		if (proxy->bindSignal(sender, descriptor, context, callback) >= 0) {
+			++connected;
+		}
+	}
+	return connected;
+}
+
 void QtSignalForwarder::disconnect(QObject* sender, const char* signal)
 {
-	sharedProxy(sender)->unbind(sender, signal);
+	QSharedPointer<QtSignalForwarder>& proxy = sharedProxyForShard(sender);
+	if (proxy && proxy->isConnected(sender)) {
+		proxy->unbind(sender, signal);
+	}
 }
 
 bool QtSignalForwarder::connect(QObject* sender, QEvent::Type event, const QtMetacallAdapter& callback, EventFilterFunc filter)
@@ -274,9 +2470,85 @@ bool QtSignalForwarder::connect(QObject* sender, QEvent::Type event, const QtMet
 	return sharedProxy(sender)->bind(sender, event, callback, filter);
 }
 
+QtSignalForwarder::Connection QtSignalForwarder::connect(QObject* sender, const char* signal, QObject* context,
+	const Pipeline& pipeline, const QtMetacallAdapter& callback
+)
+{
+	return sharedProxy(sender)->bind(sender, signal, context, pipeline, callback);
+}
+
+QtSignalForwarder::Connection QtSignalForwarder::connectDebounced(QObject* sender, const char* signal, QObject* context,
+	const QtMetacallAdapter& callback, int interval
+)
+{
+	return sharedProxy(sender)->bindDebounced(sender, signal, context, callback, interval);
+}
+
+QtSignalForwarder::Connection QtSignalForwarder::connectThrottled(QObject* sender, const char* signal, QObject* context,
+	const QtMetacallAdapter& callback, int interval, int edges
+)
+{
+	return sharedProxy(sender)->bindThrottled(sender, signal, context, callback, interval, edges);
+}
+
+bool QtSignalForwarder::connectEventFilter(QObject* sender, QEvent::Type event, const EventHandler& handler)
+{
+	return sharedProxy(sender)->bindEventFilter(sender, event, handler);
+}
+
+bool QtSignalForwarder::connectCoalesced(QObject* sender, QEvent::Type event, const EventCallback& callback,
+	int interval)
+{
+	return sharedProxy(sender)->bindCoalesced(sender, event, callback, interval);
+}
+
 void QtSignalForwarder::disconnect(QObject* sender, QEvent::Type event)
 {
-	sharedProxy(sender)->unbind(sender, event);
+	QSharedPointer<QtSignalForwarder>& proxy = sharedProxyForShard(sender);
+	if (proxy && proxy->isConnected(sender)) {
+		proxy->unbind(sender, event);
+	}
+}
+
+bool QtSignalForwarder::connect(QObject* scope, const QMetaObject* metaObject, QEvent::Type event,
+	const QtMetacallAdapter& callback, EventFilterFunc filter)
+{
+	QCoreApplication* application = QCoreApplication::instance();
+	if (!application || QThread::currentThread() != application->thread()) {
+		qWarning() << "Class event bindings can only be created from the main application thread";
+		return false;
+	}
+
+	// the callback may accept the object which received the event
+	int paramType = QMetaType::QObjectStar;
+	if (!checkTypeMatch(callback, &paramType, 1)) {
+		return false;
+	}
+
+	ClassEventFilter::Binding binding;
+	binding.hasScope = scope != 0;
+	binding.scope = scope;
+	binding.filter = filter;
+	binding.callback = new ClassEventFilter::Callback(callback);
+	ClassEventFilter::instance(true)->bind(metaObject, event, binding);
+
+	return true;
+}
+
+void QtSignalForwarder::disconnect(const QMetaObject* metaObject, QEvent::Type event)
+{
+	ClassEventFilter* filter = ClassEventFilter::instance(false);
+	if (filter) {
+		filter->unbind(metaObject, event, false, 0);
+	}
+}
+
+void QtSignalForwarder::disconnect(QObject* scope, const QMetaObject* metaObject, QEvent::Type event)
+{
+	ClassEventFilter* filter = ClassEventFilter::instance(false);
+	if (filter) {
+		filter->unbind(metaObject, event, true, scope);
+	}
 }
 
 void QtSignalForwarder::failInvoke(const QString& error)
@@ -284,15 +2556,114 @@ void QtSignalForwarder::failInvoke(const QString& error)
 	qWarning() << "Failed to invoke callback" << error;
 }
 
-void QtSignalForwarder::invokeBinding(const Binding& binding, void** arguments)
+void QtSignalForwarder::invokeBinding(const Binding& binding, const SignalDescriptor* signal, void** arguments)
+{
+	// the callback may add or remove bindings, including its own.  Neither
+	// moves or destroys the binding while it is being dispatched, see
+	// releaseSignalBinding()
+	const QtMetacallAdapter& callback = binding.callback;
+	PipelineStages* pipeline = binding.pipeline();
+
+	if (!pipeline && (!signal->hasUnresolvedTypes || callback.hasStaticArgTypes())) {
+		// common case - pass the argument vector from qt_metacall()
+		// straight through to the callback.  Typed bindings take this path
+		// even if some of the signal's types are not registered.
+		callback.invokeMetacall(arguments, signal->paramTypes, signal->paramCount);
+		return;
+	}
+
+	const void* value = signal->paramCount > 0 ? arguments[1] : 0;
+	if (pipeline) {
+		const QVector<PipelineStage*>& stages = pipeline->stages;
+		for (int i=0; i < stages.count() && value; i++) {
+			value = stages.at(i)->apply(value);
+		}
+		if (!value) {
+			return;
+		}
+	}
+
+	if (!signal->hasUnresolvedTypes) {
+		// substitute the pipeline's output for the first argument
+		void* metacallArgs[MAX_SIGNAL_ARGS + 1];
+		int types[MAX_SIGNAL_ARGS];
+		metacallArgs[0] = arguments[0];
+		for (int i=0; i < signal->paramCount; i++) {
+			metacallArgs[i+1] = arguments[i+1];
+			types[i] = signal->paramTypes[i];
+		}
+		metacallArgs[1] = const_cast<void*>(value);
+		types[0] = pipeline->outputType;
+		callback.invokeMetacall(metacallArgs, types, signal->paramCount);
+		return;
+	}
+
+	// some of the signal's parameter types are not registered, so
+	// QGenericArgument type names have to come from the signature
+	QGenericArgument args[MAX_SIGNAL_ARGS];
+	for (int i=0; i < signal->paramCount; i++) {
+		args[i] = QGenericArgument(signal->paramTypeNames.at(i).constData(), arguments[i+1]);
+	}
+	if (pipeline) {
+		args[0] = QGenericArgument(pipeline->outputTypeName, value);
+	}
+	callback.invoke(args, signal->paramCount);
+}
+
+void QtSignalForwarder::dispatchSignal(int connectionId, void** arguments)
+{
+	const SignalConnection& connection = signalConnection(connectionId);
+	const SignalDescriptor* signal = connection.signal;
+
+	if (connection.bindingIds.count() == 1) {
+		int bindingId = connection.bindingIds.at(0);
+		const Binding& binding = m_signalBindings.at(bindingId);
+		if (binding.isContextDestroyed()) {
+			removeSignalBindingAndUnbindSender(bindingId);
+		} else if (binding.rateLimiter()) {
+			rateLimitSignal(bindingId, signal, arguments);
+		} else {
+			invokeBinding(binding, signal, arguments);
+		}
+		return;
+	}
+
+	// callbacks may add or remove bindings while the list is being
+	// walked, so take a snapshot of the bindings to invoke first.
+	// Bindings added during dispatch are not invoked and bindings removed
+	// during dispatch are skipped.
+	QVarLengthArray<QPair<int,uint>,16> bindings;
+	for (int i=0; i < connection.bindingIds.count(); i++) {
+		int bindingId = connection.bindingIds.at(i);
+		bindings.append(qMakePair(bindingId, m_signalBindings.at(bindingId).generation));
+	}
+
+	for (int i=0; i < bindings.count(); i++) {
+		const Binding& binding = m_signalBindings.at(bindings.at(i).first);
+		if (binding.connectionId != connectionId || binding.generation != bindings.at(i).second) {
+			continue;
+		}
+		if (binding.isContextDestroyed()) {
+			removeSignalBindingAndUnbindSender(bindings.at(i).first);
+			continue;
+		}
+		if (binding.rateLimiter()) {
+			rateLimitSignal(bindings.at(i).first, signal, arguments);
+			continue;
+		}
+		invokeBinding(binding, signal, arguments);
+	}
+}
+
+void QtSignalForwarder::invokeConnection(int connectionId, void** arguments)
 {
-	const int MAX_ARGS = 10;
-	int argCount = binding.paramTypes.count();
-	QGenericArgument args[MAX_ARGS];
-	for (int i=0; i < argCount; i++) {
-		args[i] = QGenericArgument(binding.paramType(0), arguments[i+1]);
+	if (connectionId < m_signalConnections.count() && m_signalConnections.at(connectionId).sender) {
+		++m_dispatchDepth;
+		dispatchSignal(connectionId, arguments);
+		endDispatch();
+	} else {
+		failInvoke(QString("Unable to find matching binding for signal %1").arg(connectionId));
 	}
-	binding.callback.invoke(args, argCount);
 }
 
 int QtSignalForwarder::qt_metacall(QMetaObject::Call call, int methodId, void** arguments)
@@ -305,16 +2676,7 @@ int QtSignalForwarder::qt_metacall(QMetaObject::Call call, int methodId, void**
 		// - Both functions involve a mutex lock on the sender
 		// - The functions do not work for queued signals
 		//
-		QHash<int,Binding>::const_iterator iter = m_signalBindings.find(methodId);
-		if (iter != m_signalBindings.end()) {
-			if (iter->callback == s_senderDestroyedCallback) {
-				unbind(iter->sender);
-			} else {
-				invokeBinding(*iter, arguments);
-			}
-		} else {
-			failInvoke(QString("Unable to find matching binding for signal %1").arg(methodId));
-		}
+		invokeConnection(methodId - BINDING_METHOD_MIN_ID, arguments);
 		return -1;
 	} else {
 		// standard qt_metacall() implementation
@@ -324,51 +2686,91 @@ int QtSignalForwarder::qt_metacall(QMetaObject::Call call, int methodId, void**
 
 bool QtSignalForwarder::eventFilter(QObject* watched, QEvent* event)
 {
-	QHash<QObject*,EventBinding>::iterator iter = m_eventBindings.find(watched);
-	for (;iter != m_eventBindings.end() && iter.key() == watched; iter++) {
-		const EventBinding& binding = iter.value();
+	// most events delivered to watched objects are not of interest,
+	// so reject those first with as little work as possible
+	quint64 eventBit = eventTypeBit(event->type());
+	if (!(m_eventMask & eventBit)) {
+		return QObject::eventFilter(watched, event);
+	}
+	QHash<QObject*,EventWatch>::const_iterator iter = m_eventBindings.constFind(watched);
+	if (iter == m_eventBindings.constEnd() || !(iter->eventMask & eventBit)) {
+		return QObject::eventFilter(watched, event);
+	}
+
+	// callbacks may add or remove bindings, so collect the bindings to
+	// invoke before invoking any of them.  The copies share the bindings'
+	// function objects, which they keep alive if the bindings are removed.
+	QVarLengthArray<EventBinding,4> matches;
+	const QVarLengthArray<EventBinding,2>& bindings = iter->bindings;
+	for (int i=0; i < bindings.count(); i++) {
+		const EventBinding& binding = bindings.at(i);
 		if (binding.eventType == event->type() &&
 		    (!binding.filter || binding.filter(watched,event))) {
-			binding.callback.invoke(0, 0);
+			matches.append(binding);
+		}
+	}
+
+	bool consumed = false;
+	++m_dispatchDepth;
+	for (int i=0; i < matches.count() && !consumed; i++) {
+		const EventBinding& binding = matches.at(i);
+		if (binding.target->handler) {
+			consumed = binding.target->handler(watched, event);
+		} else if (binding.coalesced) {
+			coalesceEvent(binding, event);
+		} else {
+			binding.target->callback.invoke(0, 0);
 		}
 	}
-	return QObject::eventFilter(watched, event);
+	endDispatch();
+	return consumed || QObject::eventFilter(watched, event);
 }
 
 int QtSignalForwarder::bindingCount() const
 {
-	int totalSignalBindings = 0;
-	Q_FOREACH(const Binding& binding, m_signalBindings) {
-		if (binding.callback != s_senderDestroyedCallback) {
-			++totalSignalBindings;
-		}
-	}
-	return totalSignalBindings + m_eventBindings.size();
+	return m_bindingSlots.usedCount() - m_pendingBindingReleases.count() + m_eventBindingCount;
 }
 
 bool QtSignalForwarder::isConnected(QObject* sender) const
 {
-	QHash<QObject*,int>::const_iterator signalBindingIter = m_senderSignalBindingIds.find(sender);
-	while (signalBindingIter != m_senderSignalBindingIds.end() &&
-	       signalBindingIter.key() == sender) {
-		Q_ASSERT(m_signalBindings.contains(*signalBindingIter));
-		const Binding& binding = m_signalBindings.value(*signalBindingIter);
-		if (binding.callback != s_senderDestroyedCallback) {
-			return true;
-		}
-		++signalBindingIter;
+	return m_senderConnectionIds.contains(sender) || m_eventBindings.contains(sender);
+}
+
+bool QtSignalForwarder::isConnected(const Connection& connection) const
+{
+	return findSignalBinding(connection) >= 0;
+}
+
+QtSignalForwarder::DelayedCall QtSignalForwarder::delayedCall(int ms, QObject *context, const QtMetacallAdapter& adapter)
+{
+	if (!checkTypeMatch(adapter, 0, 0)) {
+		qWarning() << "Callback for delayed call does not take 0 arguments";
+		return DelayedCall();
+	}
+
+	QSharedPointer<TimerWheel> wheel = currentTimerWheel();
+	int id = wheel->schedule(ms, context, adapter);
+	return DelayedCall(wheel, id, wheel->generation(id));
+}
+
+bool QtSignalForwarder::DelayedCall::isPending() const
+{
+	QSharedPointer<TimerWheel> wheel = m_wheel.toStrongRef();
+	return wheel && wheel->isPending(m_id, m_generation);
+}
+
+void QtSignalForwarder::DelayedCall::cancel()
+{
+	QSharedPointer<TimerWheel> wheel = m_wheel.toStrongRef();
+	if (wheel) {
+		wheel->cancel(m_id, m_generation);
 	}
-	return m_eventBindings.contains(sender);
 }
 
-void QtSignalForwarder::delayedCall(int ms, QObject *context, const QtMetacallAdapter& adapter)
+bool QtSignalForwarder::DelayedCall::reschedule(int minDelay)
 {
-	QTimer* timer = new QTimer;
-	timer->setSingleShot(true);
-	timer->setInterval(ms);
-	QtSignalForwarder::connect(timer, SIGNAL(timeout()), context, adapter);
-	QObject::connect(timer, SIGNAL(timeout()), timer, SLOT(deleteLater()));
-	timer->start();
+	QSharedPointer<TimerWheel> wheel = m_wheel.toStrongRef();
+	return wheel && wheel->reschedule(m_id, m_generation, minDelay);
 }
 
 bool QtSignalForwarder::connectWithSender(QObject* sender, const char* signal, QObject* receiver, const char* slot)
@@ -3,8 +3,340 @@
 #include "QtMetacallAdapter.h"
 
 #include <QtCore/QEvent>
+#include <QtCore/QPointer>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QSharedData>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QVarLengthArray>
 #include <QtCore/QVector>
 
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0) && defined(QST_COMPILER_SUPPORTS_VARIADIC_TEMPLATES) && \
+    defined(QST_COMPILER_SUPPORTS_DECLTYPE)
+// connections to pointer-to-member signals require QMetaMethod::fromSignal()
+// from Qt 5 and variadic templates
+#define QST_SUPPORTS_TYPED_SIGNALS
+#endif
+
+namespace QtSignalTools
+{
+// resolved parameter types for a signal, shared by all bindings
+// to that signal.
+struct SignalDescriptor;
+class DestructionRegistry;
+class MethodIdPage;
+class ClassEventFilter;
+struct CoalescedEvent;
+struct RateLimiter;
+struct RateLimitExpiry;
+struct PipelineStages;
+class TimerWheel;
+
+// strips const and reference qualifiers from a function's argument or result
+// type, giving the type of a value which can be stored
+template <class T>
+struct StoredType
+{
+	typedef T type;
+};
+template <class T>
+struct StoredType<const T>
+{
+	typedef T type;
+};
+template <class T>
+struct StoredType<T&>
+{
+	typedef typename StoredType<T>::type type;
+};
+
+// array of records which keeps each record at a fixed address.  Records
+// are allocated in pages, so growing the array never moves existing ones.
+template <class T>
+class StableArray
+{
+	public:
+		StableArray() {}
+		~StableArray()
+		{
+			resize(0);
+		}
+
+		// returns the number of records, which is a multiple of the page size
+		int count() const
+		{
+			return m_pages.count() * PageSize;
+		}
+		const T& at(int index) const
+		{
+			return m_pages.at(index / PageSize)[index % PageSize];
+		}
+		T& operator[](int index)
+		{
+			return m_pages.at(index / PageSize)[index % PageSize];
+		}
+
+		// adds pages until there are at least @p count records, or removes
+		// pages which are entirely beyond the first @p count records
+		void resize(int count)
+		{
+			int pageCount = (count + PageSize - 1) / PageSize;
+			while (m_pages.count() > pageCount) {
+				delete[] m_pages.last();
+				m_pages.removeLast();
+			}
+			while (m_pages.count() < pageCount) {
+				m_pages.append(new T[PageSize]);
+			}
+		}
+		void reserve(int count)
+		{
+			m_pages.reserve((count + PageSize - 1) / PageSize);
+		}
+		void squeeze()
+		{
+			m_pages.squeeze();
+		}
+
+	private:
+		Q_DISABLE_COPY(StableArray)
+
+		enum { PageSize = 32 };
+		QVector<T*> m_pages;
+};
+
+// a stage in a QtSignalForwarder::Pipeline which is applied to the first
+// argument of a signal before the binding's callback is invoked
+class PipelineStage
+{
+	public:
+		virtual ~PipelineStage() {}
+
+		// creates a copy of the stage, with its own state, for a binding
+		virtual PipelineStage* clone() const = 0;
+
+		// Qt type IDs of the value which the stage accepts and the value it produces
+		virtual int inputType() const = 0;
+		virtual int outputType() const = 0;
+
+		// applies the stage to @p value.  Returns a pointer to the resulting value,
+		// which remains valid until the stage is next applied, or 0 if the
+		// signal emission should be dropped
+		virtual const void* apply(const void* value) = 0;
+};
+
+template <class T>
+class TypedPipelineStage : public PipelineStage
+{
+	public:
+		typedef typename StoredType<T>::type value_type;
+
+		virtual int inputType() const { return qMetaTypeId<value_type>(); }
+		virtual int outputType() const { return qMetaTypeId<value_type>(); }
+
+	protected:
+		static const value_type& value(const void* value)
+		{
+			return *reinterpret_cast<const value_type*>(value);
+		}
+};
+
+template <class Predicate>
+class FilterStage : public TypedPipelineStage<
+  typename FunctionTraits<typename ExtractSignature<Predicate>::type>::arg0_type>
+{
+	public:
+		FilterStage(const Predicate& predicate)
+			: m_predicate(predicate)
+		{}
+
+		virtual PipelineStage* clone() const { return new FilterStage(*this); }
+
+		virtual const void* apply(const void* value)
+		{
+			return m_predicate(FilterStage::value(value)) ? value : 0;
+		}
+
+	private:
+		Predicate m_predicate;
+};
+
+template <class Transform>
+class MapStage : public TypedPipelineStage<
+  typename FunctionTraits<typename ExtractSignature<Transform>::type>::arg0_type>
+{
+	public:
+		typedef typename StoredType<
+		  typename FunctionTraits<typename ExtractSignature<Transform>::type>::result_type>::type result_type;
+
+		MapStage(const Transform& transform)
+			: m_transform(transform)
+			, m_result()
+		{}
+
+		virtual PipelineStage* clone() const { return new MapStage(*this); }
+		virtual int outputType() const { return qMetaTypeId<result_type>(); }
+
+		virtual const void* apply(const void* value)
+		{
+			m_result = m_transform(MapStage::value(value));
+			return &m_result;
+		}
+
+	private:
+		Transform m_transform;
+		result_type m_result;
+};
+
+template <class T>
+class DistinctStage : public TypedPipelineStage<T>
+{
+	public:
+		DistinctStage()
+			: m_hasLast(false)
+			, m_last()
+		{}
+
+		virtual PipelineStage* clone() const { return new DistinctStage; }
+
+		virtual const void* apply(const void* value)
+		{
+			const T& current = DistinctStage::value(value);
+			if (m_hasLast && m_last == current) {
+				return 0;
+			}
+			m_hasLast = true;
+			m_last = current;
+			return value;
+		}
+
+	private:
+		bool m_hasLast;
+		T m_last;
+};
+
+#ifdef QST_SUPPORTS_TYPED_SIGNALS
+
+// checks at compile time that the arguments of a signal with signature
+// 'SignalSignature' can be passed to a receiver with signature 'ReceiverSignature'.
+// The receiver may take fewer arguments than the signal.
+template <class ReceiverSignature, class SignalSignature>
+struct SignalArgsCompatible;
+
+template <class R, class... SignalArgs>
+struct SignalArgsCompatible<R(), void(SignalArgs...)>
+{
+	enum { value = true };
+};
+
+template <class R, class Arg, class... Args>
+struct SignalArgsCompatible<R(Arg, Args...), void()>
+{
+	enum { value = false };
+};
+
+template <class R, class Arg, class... Args, class SignalArg, class... SignalArgs>
+struct SignalArgsCompatible<R(Arg, Args...), void(SignalArg, SignalArgs...)>
+{
+	enum { value = qst_functional::is_convertible<typename StoredType<SignalArg>::type&, Arg>::value &&
+	               SignalArgsCompatible<R(Args...), void(SignalArgs...)>::value };
+};
+
+// returns the type at position N in Types
+template <int N, class... Types>
+struct TypeAt;
+
+template <class T, class... Types>
+struct TypeAt<0, T, Types...>
+{
+	typedef T type;
+};
+
+template <int N, class T, class... Types>
+struct TypeAt<N, T, Types...> : TypeAt<N-1, Types...>
+{
+};
+
+// returns the type ID of T, or 0 if T is not registered with Qt's meta-type system.
+// Signals connected by pointer-to-member may use types which are not registered.
+template <class T, bool Defined = QMetaTypeId2<T>::Defined>
+struct OptionalMetaTypeId
+{
+	static int id() { return qMetaTypeId<T>(); }
+};
+
+template <class T>
+struct OptionalMetaTypeId<T,false>
+{
+	static int id() { return 0; }
+};
+
+// adapter for a binding to a pointer-to-member signal.  The types of the
+// signal's arguments are known at compile time, so the arguments are cast
+// to the signal's types and converted to the receiver's types by the compiler.
+template <class Functor, class... SignalArgs>
+struct TypedSignalAdapterImpl : QtMetacallAdapterImplBase<Functor>
+{
+	typedef QtMetacallAdapterImplBase<Functor> Base;
+	enum { ArgCount = Base::traits::count };
+	typedef typename MakeIndexSequence<ArgCount>::type Indexes;
+
+	TypedSignalAdapterImpl(const Functor& functor)
+	: Base(functor)
+	{}
+
+	template <int... I>
+	void invokeArgs(const QGenericArgument* args, IndexSequence<I...>) const
+	{
+		(void)args;
+		Base::functor(*reinterpret_cast<typename StoredType<typename TypeAt<I, SignalArgs...>::type>::type*>(args[I].data())...);
+	}
+
+	template <int... I>
+	void invokeMetacallArgs(void** args, IndexSequence<I...>) const
+	{
+		(void)args;
+		Base::functor(*reinterpret_cast<typename StoredType<typename TypeAt<I, SignalArgs...>::type>::type*>(args[I+1])...);
+	}
+
+	virtual bool invoke(const QGenericArgument* args, int count) const {
+		if (count < ArgCount) {
+			return false;
+		}
+		invokeArgs(args, Indexes());
+		return true;
+	}
+
+	virtual bool invokeMetacall(void** args, const int* types, int count) const {
+		(void)types;
+		if (count < ArgCount) {
+			return false;
+		}
+		invokeMetacallArgs(args, Indexes());
+		return true;
+	}
+
+	virtual int getArgTypes(QtMetacallArgsArray args) const {
+		static const int types[] = {
+			OptionalMetaTypeId<typename StoredType<SignalArgs>::type>::id()..., 0
+		};
+		for (int i=0; i < ArgCount; i++) {
+			args[i] = types[i];
+		}
+		return ArgCount;
+	}
+
+	virtual bool hasStaticArgTypes() const {
+		return true;
+	}
+
+	virtual QtMetacallAdapterImplIface* clone(void* storage) const {
+		return new (storage) TypedSignalAdapterImpl(*this);
+	}
+};
+
+#endif // QST_SUPPORTS_TYPED_SIGNALS
+}
+
 /** QtSignalForwarder provides a way to connect Qt signals to QtCallback objects
  * or function objects (wrappers around functions such as std::tr1::function,
  * boost::function or std::function).
@@ -53,6 +385,136 @@ class QtSignalForwarder : public QObject
 
 		typedef bool (*EventFilterFunc)(QObject*,QEvent*);
 
+		/** Handler for an event binding which receives the event and returns
+		 * true to consume it, see bindEventFilter().
+		 */
+		typedef QtSignalTools::qst_functional::function<bool(QObject*,QEvent*)> EventHandler;
+
+		/** Callback for a coalesced event binding which receives the sender and
+		 * a copy of the latest event, see bindCoalesced().
+		 */
+		typedef QtSignalTools::qst_functional::function<void(QObject*,QEvent*)> EventCallback;
+
+		/** A handle to a single signal binding, returned by bind() and connect().
+		 *
+		 * The handle can be used to remove exactly that binding without affecting
+		 * any other bindings for the same sender or signal.  Handles are cheap to
+		 * copy and do not keep the binding alive.  Once the binding has been removed,
+		 * by any means, the handle becomes stale and disconnect() does nothing.
+		 *
+		 * A Connection converts to true if the binding was successfully set up, so
+		 * code which tests the result of connect() as a bool continues to work.
+		 */
+		class ConnectionGroup;
+		class Connection
+		{
+			// safe-bool idiom, see operator SafeBool() below
+			typedef void (Connection::*SafeBool)() const;
+
+			public:
+				Connection()
+					: m_bindingId(-1)
+					, m_generation(0)
+				{}
+
+				/** Returns true if the binding referred to by this handle
+				 * still exists.
+				 */
+				bool isConnected() const;
+
+				/** Removes the binding referred to by this handle.  Has no effect
+				 * if the binding has already been removed or the proxy has been destroyed.
+				 */
+				void disconnect();
+
+				// returns true if a binding was created when this handle was returned,
+				// regardless of whether it has since been removed
+				operator SafeBool() const
+				{
+					return m_bindingId >= 0 ? &Connection::safeBoolTrue : 0;
+				}
+
+			private:
+				friend class QtSignalForwarder;
+				friend class ConnectionGroup;
+
+				Connection(QtSignalForwarder* proxy, int bindingId, uint generation)
+					: m_proxy(proxy)
+					, m_bindingId(bindingId)
+					, m_generation(generation)
+				{}
+
+				void safeBoolTrue() const {}
+
+				QPointer<QtSignalForwarder> m_proxy;
+				int m_bindingId;
+				uint m_generation;
+		};
+
+		/** ConnectionGroup collects signal bindings and removes all of them
+		 * when the group is destroyed or disconnectAll() is called.
+		 *
+		 * Removal is batched per proxy, which is considerably cheaper than
+		 * removing each binding individually or waiting for the senders to be destroyed.
+		 * This is useful for tearing down all of the connections made by a dialog or
+		 * other component with many child objects in one go.
+		 *
+		 * A group may contain bindings from several proxies, but like the proxies
+		 * themselves it should only be used from a single thread.
+		 *
+		 * Example usage:
+		 *
+		 *  QtSignalForwarder::ConnectionGroup connections;
+		 *  connections.connect(&button, SIGNAL(clicked(bool)), callback);
+		 *  connections.add(proxy.bind(&editor, SIGNAL(textChanged(QString)), otherCallback));
+		 */
+		class ConnectionGroup
+		{
+			public:
+				ConnectionGroup() {}
+				~ConnectionGroup()
+				{
+					disconnectAll();
+				}
+
+				/** Install a proxy which invokes @p callback when @p sender emits @p signal
+				 * and add the resulting binding to the group.
+				 * See QtSignalForwarder::connect()
+				 */
+				Connection connect(QObject* sender, const char* signal, QObject* context,
+					const QtMetacallAdapter& callback
+				);
+				Connection connect(QObject* sender, const char* signal,
+					const QtMetacallAdapter& callback
+				)
+				{
+					return connect(sender, signal, 0, callback);
+				}
+
+				/** Add an existing binding to the group.  Null handles are ignored. */
+				void add(const Connection& connection);
+
+				/** Remove all of the bindings in the group which still exist
+				 * and clear the group.
+				 */
+				void disconnectAll();
+
+				/** Returns the number of bindings which have been added to the group,
+				 * including any which have since been removed by other means.
+				 */
+				int count() const
+				{
+					return m_connections.count();
+				}
+
+			private:
+				Q_DISABLE_COPY(ConnectionGroup)
+
+				static bool proxyLessThan(const Connection& a, const Connection& b);
+
+				QVector<Connection> m_connections;
+		};
+
 		QtSignalForwarder(QObject* parent = 0);
 		virtual ~QtSignalForwarder();
 
@@ -67,28 +529,193 @@ class QtSignalForwarder : public QObject
 		 * The connection will automatically disconnect if the sender or the
 		 * @p context context is destroyed.
 		 */
-		bool bind(QObject* sender, const char* signal, QObject *context,
+		Connection bind(QObject* sender, const char* signal, QObject *context,
 			const QtMetacallAdapter& callback
 		);
-		bool bind(QObject* sender, const char* signal, const QtMetacallAdapter& callback)
+		Connection bind(QObject* sender, const char* signal, const QtMetacallAdapter& callback)
 		{
 			return bind(sender, signal, 0, callback);
 		}
 
+#ifdef QST_SUPPORTS_TYPED_SIGNALS
+		/** Set up a binding so that @p callback is invoked when @p sender emits
+		 * the signal given by a pointer-to-member, eg. &QSlider::valueChanged.
+		 *
+		 * @p callback must be a function pointer or a function object with a
+		 * single non-template operator(), eg. a lambda.  Its argument types are
+		 * checked against the signal's at compile time and may be any types which
+		 * the signal's arguments convert to.  No type checks are done when the
+		 * binding is set up or when the signal is emitted, and the signal's
+		 * argument types do not need to be registered with Qt.
+		 */
+		template <class Sender, class SignalClass, class... SignalArgs, class Callback>
+		Connection bind(Sender* sender, void (SignalClass::*signal)(SignalArgs...), QObject* context,
+			Callback callback
+		)
+		{
+			return bindTypedSignal(sender, QMetaMethod::fromSignal(signal).methodIndex(), context,
+			  typedSignalAdapter<Sender, SignalClass, SignalArgs...>(callback));
+		}
+		template <class Sender, class SignalClass, class... SignalArgs, class Callback>
+		Connection bind(Sender* sender, void (SignalClass::*signal)(SignalArgs...), Callback callback)
+		{
+			return bind(sender, signal, 0, callback);
+		}
+#endif
+
+		/** Edges of a burst of signal emissions on which a throttled binding
+		 * invokes its callback, see bindThrottled().
+		 */
+		enum ThrottleEdge
+		{
+			/** Invoke the callback immediately for the first emission in a burst. */
+			LeadingEdge = 0x1,
+			/** Invoke the callback with the latest arguments once the interval
+			 * following an invocation has elapsed.
+			 */
+			TrailingEdge = 0x2
+		};
+
+		/** A sequence of filters and transforms which are applied to the first
+		 * argument of a signal before a binding's callback is invoked.
+		 *
+		 * The stages run inline when the signal is delivered.  The types of each stage
+		 * are checked against the signal and the callback when the binding is created.
+		 *
+		 * Example, invoking a callback with a bool when a slider's value crosses 50:
+		 *
+		 *   QtSignalForwarder::Pipeline pipeline;
+		 *   pipeline.map(isAboveHalfway).distinct<bool>();
+		 *   QtSignalForwarder::connect(slider, SIGNAL(valueChanged(int)), 0, pipeline, callback);
+		 *
+		 * Filters and transforms may be plain functions or function objects with a
+		 * single argument whose signature can be determined, eg. std::tr1::function.
+		 */
+		class Pipeline
+		{
+			public:
+				/** Drop emissions for which @p predicate returns false. */
+				template <class Predicate>
+				Pipeline& filter(Predicate predicate)
+				{
+					return append(new QtSignalTools::FilterStage<Predicate>(predicate));
+				}
+
+				/** Replace the value with the result of @p transform. */
+				template <class Transform>
+				Pipeline& map(Transform transform)
+				{
+					return append(new QtSignalTools::MapStage<Transform>(transform));
+				}
+
+				/** Drop emissions where the value of type T is equal to the
+				 * value from the previous emission which passed this stage.
+				 */
+				template <class T>
+				Pipeline& distinct()
+				{
+					return append(new QtSignalTools::DistinctStage<T>);
+				}
+
+				bool isEmpty() const
+				{
+					return m_stages.isEmpty();
+				}
+
+			private:
+				friend class QtSignalForwarder;
+
+				Pipeline& append(QtSignalTools::PipelineStage* stage)
+				{
+					m_stages << QSharedPointer<QtSignalTools::PipelineStage>(stage);
+					return *this;
+				}
+
+				QVector<QSharedPointer<QtSignalTools::PipelineStage> > m_stages;
+		};
+
+		/** Set up a binding which invokes @p callback with the result of
+		 * applying @p pipeline to the first argument of @p signal.  The remaining
+		 * signal arguments are passed to the callback unchanged.
+		 *
+		 * Each binding has its own copy of the pipeline's state, eg. the previous
+		 * value for a distinct() stage.
+		 */
+		Connection bind(QObject* sender, const char* signal, QObject* context, const Pipeline& pipeline,
+			const QtMetacallAdapter& callback
+		);
+
+		/** Set up a binding which invokes @p callback once @p sender has not
+		 * emitted @p signal for @p interval milliseconds.  The callback is invoked
+		 * with the arguments from the latest emission.
+		 *
+		 * Only the latest arguments are kept, so a burst of emissions does not
+		 * queue anything.  Arguments which the callback does not take are discarded.
+		 */
+		Connection bindDebounced(QObject* sender, const char* signal, QObject* context,
+			const QtMetacallAdapter& callback, int interval
+		);
+
+		/** Set up a binding which invokes @p callback at most once every
+		 * @p interval milliseconds when @p sender emits @p signal.
+		 *
+		 * @p edges is a combination of ThrottleEdge flags.  With LeadingEdge, the
+		 * first emission after a quiet interval invokes the callback immediately.
+		 * With TrailingEdge, emissions during the interval following an invocation
+		 * are not dropped, instead the callback is invoked with the latest arguments
+		 * once the interval has elapsed.
+		 */
+		Connection bindThrottled(QObject* sender, const char* signal, QObject* context,
+			const QtMetacallAdapter& callback, int interval, int edges = LeadingEdge | TrailingEdge
+		);
+
 		/** Set up a binding so that @p callback is invoked when @p sender
 		 * receives @p event.
 		 */
 		bool bind(QObject* sender, QEvent::Type event, const QtMetacallAdapter& callback, EventFilterFunc filter = 0);
 
+		/** Set up a binding so that @p handler is invoked when @p sender
+		 * receives @p event.
+		 *
+		 * The handler is called with the sender and the event.  If it returns true,
+		 * the event is consumed: it is not passed to any later bindings for
+		 * @p sender or delivered to @p sender itself, in the same way as returning
+		 * true from QObject::eventFilter().
+		 */
+		bool bindEventFilter(QObject* sender, QEvent::Type event, const EventHandler& handler);
+
+		/** Set up a binding which coalesces @p event for @p sender.
+		 *
+		 * Instead of being invoked synchronously for each event, @p callback is
+		 * invoked at most once every @p interval milliseconds with a copy of
+		 * the latest event received since the last invocation.  If @p interval
+		 * is 0, @p callback is invoked at most once per event loop iteration.
+		 *
+		 * This is intended for high-frequency events such as QEvent::MouseMove,
+		 * QEvent::Wheel, QEvent::Resize or QEvent::Move where only the latest state
+		 * is of interest.  The copy of the event passed to the callback has
+		 * the event's concrete type for mouse, wheel, hover, move and resize
+		 * events when QtGui is available.  For other event types, the copy is a plain
+		 * QEvent of the same type.
+		 */
+		bool bindCoalesced(QObject* sender, QEvent::Type event, const EventCallback& callback, int interval = 0);
+
 		/** Remove all bindings from a given @p sender and signal. */
 		void unbind(QObject* sender, const char* signal);
 
 		/** Remove all bindings from a given @p sender and event. */
 		void unbind(QObject* sender, QEvent::Type event);
 
-		/** Remove all bindings from a given @p sender. */
+		/** Remove all bindings from a given @p sender and all bindings
+		 * whose context is @p sender.
+		 */
 		void unbind(QObject* sender);
 
+		/** Remove the single binding referred to by @p connection.  Has no effect if
+		 * the binding has already been removed or belongs to a different proxy.
+		 */
+		void unbind(const Connection& connection);
+
 		/** Returns the total number of active bindings for this
 		 * QtSignalForwarder instance.
 		 */
@@ -96,17 +723,105 @@ class QtSignalForwarder : public QObject
 
 		bool isConnected(QObject* sender) const;
 
+		/** Returns true if the binding referred to by @p connection belongs to this
+		 * proxy and has not been removed.
+		 */
+		bool isConnected(const Connection& connection) const;
+
+		/** Specifies how a proxy detects the destruction of the context objects
+		 * passed to bind().
+		 */
+		enum ContextTracking
+		{
+			/** Each context is watched for destruction and its bindings
+			 * are removed as soon as it is destroyed.  This is the default.
+			 */
+			EagerContextTracking,
+			/** Each binding keeps a weak reference to its context which is checked
+			 * when the signal is emitted.  Bindings whose context has been destroyed
+			 * are skipped and then removed, either when the signal is next emitted or
+			 * by an incremental sweep as new bindings are added.
+			 *
+			 * This avoids the cost of watching each context for destruction, at the
+			 * expense of a check on each emission, and is suited to bindings with many
+			 * short-lived contexts whose signals are emitted rarely.
+			 * Until they are removed, bindings with a destroyed context are still
+			 * included in bindingCount().
+			 */
+			LazyContextTracking
+		};
+
+		/** Sets how the destruction of context objects is detected for bindings
+		 * added to this proxy after the call.
+		 */
+		void setContextTracking(ContextTracking mode)
+		{
+			m_contextTracking = mode;
+		}
+		ContextTracking contextTracking() const
+		{
+			return m_contextTracking;
+		}
+
+		/** Removes all bindings whose context has been destroyed and which have
+		 * not yet been removed.  This only applies to bindings added
+		 * using LazyContextTracking.
+		 */
+		void sweepContexts();
+
+		/** A handle to a call scheduled by delayedCall().
+		 *
+		 * The handle may only be used from the thread which scheduled the call.
+		 * None of its methods allocate memory.
+		 */
+		class DelayedCall
+		{
+			public:
+				DelayedCall()
+					: m_id(-1)
+					, m_generation(0)
+				{}
+
+				/** Returns true if the call has not yet been made or cancelled. */
+				bool isPending() const;
+
+				/** Cancels the call if it is still pending. */
+				void cancel();
+
+				/** Moves a pending call so that it is made after @p minDelay ms
+				 * from now instead of at its original time.
+				 *
+				 * Returns false if the call has already been made or cancelled.
+				 */
+				bool reschedule(int minDelay);
+
+			private:
+				friend class QtSignalForwarder;
+
+				DelayedCall(const QSharedPointer<QtSignalTools::TimerWheel>& wheel, int id, uint generation)
+					: m_wheel(wheel)
+					, m_id(id)
+					, m_generation(generation)
+				{}
+
+				QWeakPointer<QtSignalTools::TimerWheel> m_wheel;
+				int m_id;
+				uint m_generation;
+		};
+
 		/** Schedule a delayed call to @p callback after @p minDelay ms.
 		 *
 		 * The connection will automatically disconnect if the
 		 * @p context context is destroyed.
+		 *
+		 * Returns a handle which can be used to cancel or reschedule the call.
 		 */
-		static void delayedCall(int minDelay, QObject *context,
+		static DelayedCall delayedCall(int minDelay, QObject *context,
 			const QtMetacallAdapter& callback
 		);
-		static void delayedCall(int minDelay, const QtMetacallAdapter& callback)
+		static DelayedCall delayedCall(int minDelay, const QtMetacallAdapter& callback)
 		{
-			delayedCall(minDelay, 0, callback);
+			return delayedCall(minDelay, 0, callback);
 		}
 
 		// re-implemented from QObject (this method is normally declared via the Q_OBJECT
@@ -121,23 +836,141 @@ class QtSignalForwarder : public QObject
 		 * The connection will automatically disconnect if the sender or the
 		 * @p context context is destroyed.
 		 */
-		static bool connect(QObject* sender, const char* signal, QObject *context,
+		static Connection connect(QObject* sender, const char* signal, QObject *context,
 			const QtMetacallAdapter& callback
 		);
-		static bool connect(QObject* sender, const char* signal,
+		static Connection connect(QObject* sender, const char* signal,
 			const QtMetacallAdapter& callback
 		)
 		{
 			return connect(sender, signal, 0, callback);
 		}
 
+#ifdef QST_SUPPORTS_TYPED_SIGNALS
+		/** Install a proxy which invokes @p callback when @p sender emits
+		 * the signal given by a pointer-to-member, eg. &QSlider::valueChanged.
+		 * See bind(Sender*, void (SignalClass::*)(SignalArgs...), QObject*, Callback).
+		 */
+		template <class Sender, class SignalClass, class... SignalArgs, class Callback>
+		static Connection connect(Sender* sender, void (SignalClass::*signal)(SignalArgs...), QObject* context,
+			Callback callback
+		)
+		{
+			return sharedProxy(sender)->bind(sender, signal, context, callback);
+		}
+		template <class Sender, class SignalClass, class... SignalArgs, class Callback>
+		static Connection connect(Sender* sender, void (SignalClass::*signal)(SignalArgs...), Callback callback)
+		{
+			return connect(sender, signal, 0, callback);
+		}
+#endif
+
 		static void disconnect(QObject* sender, const char* signal);
 
+		/** Remove the single binding referred to by @p connection.
+		 * This is equivalent to connection.disconnect().
+		 */
+		static void disconnect(Connection connection)
+		{
+			connection.disconnect();
+		}
+
+		/** Install a proxy which applies @p pipeline to @p signal before invoking @p callback.
+		 * See bind(QObject*, const char*, QObject*, const Pipeline&, const QtMetacallAdapter&).
+		 */
+		static Connection connect(QObject* sender, const char* signal, QObject* context, const Pipeline& pipeline,
+			const QtMetacallAdapter& callback
+		);
+
+		/** Install a proxy which debounces @p signal from @p sender, see bindDebounced(). */
+		static Connection connectDebounced(QObject* sender, const char* signal, QObject* context,
+			const QtMetacallAdapter& callback, int interval
+		);
+
+		/** Install a proxy which throttles @p signal from @p sender, see bindThrottled(). */
+		static Connection connectThrottled(QObject* sender, const char* signal, QObject* context,
+			const QtMetacallAdapter& callback, int interval, int edges = LeadingEdge | TrailingEdge
+		);
+
+		/** Install proxies which invoke a callback when any of the senders
+		 * in the range [@p begin, @p end) emits @p signal.  The callback for each
+		 * sender is created by calling @p factory with the sender as
+		 * the argument.
+		 *
+		 * This is equivalent to calling connect() for each sender, but the signal
+		 * is resolved and the callback types are checked once per batch rather than once
+		 * per sender, and space for the new bindings is reserved up front.
+		 *
+		 * Returns the number of senders which were successfully connected.
+		 */
+		template <class InputIterator, class CallbackFactory>
+		static int connectEach(InputIterator begin, InputIterator end, const char* signal, QObject* context,
+			CallbackFactory factory
+		)
+		{
+			QVector<QObject*> senders;
+			QVector<QtMetacallAdapter> callbacks;
+			for (; begin != end; ++begin) {
+				senders << *begin;
+				callbacks << QtMetacallAdapter(factory(*begin));
+			}
+			return connectBatch(senders, signal, context, callbacks);
+		}
+		template <class InputIterator, class CallbackFactory>
+		static int connectEach(InputIterator begin, InputIterator end, const char* signal,
+			CallbackFactory factory
+		)
+		{
+			return connectEach(begin, end, signal, 0, factory);
+		}
+
 		/** Install a proxy which invokes @p callback when @p sender receives @p event.
 		 */
 		static bool connect(QObject* sender, QEvent::Type event, const QtMetacallAdapter& callback, EventFilterFunc filter = 0);
 		static void disconnect(QObject* sender, QEvent::Type event);
 
+		/** Install a proxy which invokes @p handler when @p sender receives @p event.
+		 * See bindEventFilter().  The binding is removed by disconnect(sender, event).
+		 */
+		static bool connectEventFilter(QObject* sender, QEvent::Type event, const EventHandler& handler);
+
+		/** Install a proxy which coalesces @p event for @p sender, see bindCoalesced().
+		 * The binding is removed by disconnect(sender, event).
+		 */
+		static bool connectCoalesced(QObject* sender, QEvent::Type event, const EventCallback& callback,
+		                             int interval = 0);
+
+		/** Install a binding which invokes @p callback when any object which is
+		 * an instance of the class described by @p metaObject, or of a class derived
+		 * from it, receives @p event.  If @p scope is specified, only @p scope and
+		 * its descendants are matched.
+		 *
+		 * Rather than installing an event filter on each matching object,
+		 * all class bindings are dispatched from a single event filter installed
+		 * on the application object, so these bindings only apply to objects which
+		 * live in the main application thread.
+		 *
+		 * The callback may take the object which received the event as a QObject*
+		 * argument.
+		 *
+		 * For example: connect(&QAbstractButton::staticMetaObject, QEvent::Enter, callback)
+		 */
+		static bool connect(const QMetaObject* metaObject, QEvent::Type event, const QtMetacallAdapter& callback,
+		                    EventFilterFunc filter = 0)
+		{
+			return connect(0, metaObject, event, callback, filter);
+		}
+		static bool connect(QObject* scope, const QMetaObject* metaObject, QEvent::Type event,
+		                    const QtMetacallAdapter& callback, EventFilterFunc filter = 0);
+
+		/** Remove all class bindings for @p metaObject and @p event, regardless of scope. */
+		static void disconnect(const QMetaObject* metaObject, QEvent::Type event);
+
+		/** Remove the class bindings for @p metaObject and @p event which were
+		 * installed with a given @p scope.
+		 */
+		static void disconnect(QObject* scope, const QMetaObject* metaObject, QEvent::Type event);
+
 		/** Convenience method which connects a signal to a slot which takes a pointer
 		 * to the sender as the first argument. This can be used as an alternative to explicitly checking
 		 * the sender in the slot itself or using QSignalMapper.
@@ -152,32 +985,199 @@ class QtSignalForwarder : public QObject
 		// re-implemented from QObject
 		virtual bool eventFilter(QObject* watched, QEvent* event);
 
+	protected:
+		// re-implemented from QObject
+		virtual void timerEvent(QTimerEvent* event);
+
+	public:
+
+		/** Sets the number of shared proxies used by the static connect() methods
+		 * in each thread.  Senders are assigned to a proxy by hashing the sender's address,
+		 * so all of a sender's bindings are held by the same proxy.
+		 *
+		 * Using several proxies limits the number of senders connected to each
+		 * one, which matters because some QObject operations are linear in the number of
+		 * connected senders.
+		 *
+		 * The count applies to threads which have not yet made any connections
+		 * via the static connect() methods, so this should be called during
+		 * application startup.
+		 */
+		static void setSharedProxyCount(int count);
+		static int sharedProxyCount();
+
+		/** Releases memory held by the calling thread's shared proxies which
+		 * is no longer needed after bindings have been removed.
+		 *
+		 * Empty shared proxies are destroyed, to be re-created when next needed,
+		 * and the internal tables of the remaining proxies are shrunk to fit
+		 * their current bindings.  Sparse tables and unused receivers for method IDs
+		 * are also released automatically as bindings are removed, but this can be
+		 * called from idle time after a large number of bindings have been removed.
+		 */
+		static void compact();
+
+		/** Statistics for the process-wide cache which maps signal signatures
+		 * passed to bind(), unbind(), connect() and disconnect() to signal indexes.
+		 */
+		struct SignalIndexCacheStats
+		{
+			int hits;
+			int misses;
+			// number of cached (class, signature) entries
+			int size;
+		};
+
+		static SignalIndexCacheStats signalIndexCacheStats();
+
+		/** Removes all entries from the signal index cache and resets
+		 * its statistics.  This is mainly useful for testing and benchmarking.
+		 */
+		static void clearSignalIndexCache();
+
 	private:
+		friend class QtSignalTools::DestructionRegistry;
+		friend class QtSignalTools::MethodIdPage;
+		friend class QtSignalTools::ClassEventFilter;
+		friend struct QtSignalTools::RateLimitExpiry;
+
+		// tracks which slots in a dense array of records are in use, with
+		// one bit per slot
+		class SlotMap
+		{
+			public:
+				SlotMap()
+					: m_firstFreeWord(0)
+					, m_usedCount(0)
+				{}
+
+				// marks the first free slot as used, growing the map
+				// if necessary, and returns its index
+				int alloc();
+				void release(int slot);
+				void reserve(int count);
+				// releases space used by free slots at the end of the map
+				void squeeze();
+
+				// returns the number of slots, including free slots
+				int capacity() const;
+				int usedCount() const
+				{
+					return m_usedCount;
+				}
+
+			private:
+				// bitmap of free slots
+				QVector<quint32> m_freeSlots;
+				// index of the first word in m_freeSlots which may
+				// have free slots
+				int m_firstFreeWord;
+				int m_usedCount;
+		};
+
+		// a Qt-level connection from a (sender, signal) pair to this proxy.
+		// Each connection has its own (receiver, method ID) pair and invokes all of the
+		// bindings for that (sender, signal) pair when the signal is emitted.
+		//
+		// Connections are stored in a flat array indexed by connection ID, so the
+		// fields which qt_metacall() needs for dispatch are kept together
+		// and small enough to share a cache line
+		struct SignalConnection
+		{
+			SignalConnection()
+				: sender(0)
+				, signal(0)
+			{}
+
+			QObject* sender;
+			const QtSignalTools::SignalDescriptor* signal;
+			// IDs of bindings to invoke, in the order they were added
+			QVarLengthArray<int,2> bindingIds;
+		};
+
+		// the parts of a binding which only some bindings use.  These are
+		// allocated separately to keep the binding array compact.
+		struct BindingExtras
+		{
+			BindingExtras()
+				: hasContextGuard(false)
+			{}
+
+			// set if the binding uses LazyContextTracking, in which case
+			// the context is referenced by contextGuard instead of context
+			bool hasContextGuard;
+			QPointer<QObject> contextGuard;
+			// set for bindings created by bindDebounced() or bindThrottled()
+			QSharedPointer<QtSignalTools::RateLimiter> rateLimiter;
+			// set for bindings with a Pipeline
+			QSharedPointer<QtSignalTools::PipelineStages> pipeline;
+		};
+
 		struct Binding
 		{
-			Binding(QObject* _sender = 0, int _signalIndex = -1,
-				QObject *_context = 0,
-				const QtMetacallAdapter& _callback = QtMetacallAdapter()
-			)
-				: sender(_sender)
-				, context(_context)
-				, signalIndex(_signalIndex)
-				, callback(_callback)
+			Binding()
+				: connectionId(-1)
+				, generation(0)
+				, context(0)
 			{}
 
-			const char* paramType(int index) const
+			// returns true if the binding uses LazyContextTracking
+			// and its context has been destroyed
+			bool isContextDestroyed() const
+			{
+				return extras && extras->hasContextGuard && extras->contextGuard.isNull();
+			}
+
+			bool hasContextGuard() const
+			{
+				return extras && extras->hasContextGuard;
+			}
+
+			QtSignalTools::RateLimiter* rateLimiter() const
+			{
+				return extras ? extras->rateLimiter.data() : 0;
+			}
+
+			QtSignalTools::PipelineStages* pipeline() const
 			{
-				if (index >= paramTypes.count()) {
-					return 0;
+				return extras ? extras->pipeline.data() : 0;
+			}
+
+			// returns the binding's extras, allocating them if necessary
+			BindingExtras& ensureExtras()
+			{
+				if (!extras) {
+					extras.reset(new BindingExtras);
 				}
-				return paramTypes.at(index).constData();
+				return *extras;
 			}
 
-			QObject* sender;
+			// ID of the SignalConnection this binding belongs to
+			int connectionId;
+			// unique (per proxy) ID assigned when the binding's slot is used,
+			// so that handles to earlier bindings in the slot can be detected
+			uint generation;
 			QObject* context;
-			int signalIndex;
-			QList<QByteArray> paramTypes;
 			QtMetacallAdapter callback;
+			// null unless the binding has a context guard, a rate limiter
+			// or a pipeline
+			QScopedPointer<BindingExtras> extras;
+		};
+
+		// the function objects invoked by an event binding.  These are shared
+		// by reference, so eventFilter() can keep the bindings it dispatches to
+		// alive without copying their function objects.
+		struct EventTarget : public QSharedData
+		{
+			EventTarget(const QtMetacallAdapter& _callback)
+				: callback(_callback)
+			{}
+
+			QtMetacallAdapter callback;
+
+			// for bindings created by bindEventFilter(), the handler
+			// replaces the filter and callback
+			EventHandler handler;
 		};
 
 		struct EventBinding
@@ -187,44 +1187,217 @@ class QtSignalForwarder : public QObject
 				: sender(_sender)
 				, eventType(_type)
 				, filter(_filter)
-				, callback(_callback)
+				, target(new EventTarget(_callback))
 			{}
 
 			QObject* sender;
 			QEvent::Type eventType;
 			EventFilterFunc filter;
-			QtMetacallAdapter callback;
+			QExplicitlySharedDataPointer<EventTarget> target;
+
+			// pending delivery for bindings created by bindCoalesced()
+			QSharedPointer<QtSignalTools::CoalescedEvent> coalesced;
+		};
+
+		// the event bindings for an object which the proxy is
+		// filtering events for
+		struct EventWatch
+		{
+			EventWatch()
+				: eventMask(0)
+			{}
+
+			// bitmask of the event types which have bindings, see eventTypeBit()
+			quint64 eventMask;
+			QVarLengthArray<EventBinding,2> bindings;
 		};
 
-		// returns the first binding for (sender, signalIndex)
-		const Binding* matchBinding(QObject* sender, int signalIndex) const;
+		// returns the bit for an event type in EventWatch::eventMask.
+		// Event types share bits modulo 64, so a set bit only indicates
+		// that there may be a binding for the event type.
+		static quint64 eventTypeBit(int eventType)
+		{
+			return Q_UINT64_C(1) << (eventType & 63);
+		}
+		void addEventBinding(const EventBinding& binding);
+		// cancels any pending delivery for a binding which is being removed
+		void releaseEventBinding(const EventBinding& binding);
+		void coalesceEvent(const EventBinding& binding, QEvent* event);
+
+		Connection bindRateLimited(QObject* sender, const char* signal, QObject* context,
+			const QtMetacallAdapter& callback, const QSharedPointer<QtSignalTools::RateLimiter>& rateLimiter
+		);
+		// handles an emission for a binding created by bindRateLimited()
+		void rateLimitSignal(int bindingId, const QtSignalTools::SignalDescriptor* signal, void** arguments);
+		// starts a new interval for a rate-limited binding
+		void startRateLimitTimer(QtSignalTools::RateLimiter* rateLimiter);
+		// called when the timer for a rate-limited binding expires
+		static void rateLimitExpired(const Connection& connection);
+		void invokeRateLimited(int bindingId);
+		// updates m_eventTypeCounts and m_eventMask
+		void addEventTypes(quint64 mask);
+		void removeEventTypes(quint64 mask);
+		// removes the event bindings for @p watched and updates the proxy-wide mask
+		void removeEventWatch(QObject* watched);
+
+		// returns true if the proxy has no bindings and is not currently
+		// dispatching a signal or event
+		bool isIdle() const;
+		// shrinks the hash tables if they are sparsely occupied
+		void squeezeIfSparse();
+		// shrinks all internal tables to fit the current bindings
+		void compactStorage();
+
 		void failInvoke(const QString& error);
-		void setupDestroyNotify(QObject* sender);
+		// registers for notification when @p object is destroyed, so that
+		// bindings which refer to it can be removed
+		void setupDestroyNotify(QObject* object);
+		// stops listening for destruction of @p object if the proxy no longer
+		// has any bindings which refer to it
+		void releaseDestroyNotify(QObject* object);
+		// called by the destruction registry when a watched object is destroyed
+		void objectDestroyed(QObject* object, void** arguments);
 
-		// returns false if the limit on the number of signal bindings
-		// per proxy has been reached
-		bool canAddSignalBindings() const;
+		const SignalConnection& signalConnection(int connectionId) const;
+		// returns the ID of the connection for (sender, signalIndex)
+		// or -1 if there is none
+		int findSignalConnection(QObject* sender, int signalIndex) const;
+		// removes a connection and all of its bindings
+		void removeSignalConnection(int connectionId);
+		// removes the Qt connection for a signal connection
+		void disconnectSignalConnection(int connectionId);
+		// removes a binding from its connection.  If this leaves the
+		// connection empty, it is removed as well
+		void removeSignalBinding(int bindingId);
+		// frees the slots used by a connection and its bindings without
+		// disconnecting the Qt connection or updating m_senderConnectionIds
+		void releaseSignalConnection(int connectionId);
+		// frees the slot used by a binding without updating its connection.
+		// During dispatch, the callback is kept and the slot is not re-used
+		// until the outermost dispatch finishes, see releasePendingBindings()
+		void releaseSignalBinding(int bindingId);
+		// frees the slots of bindings which were removed during dispatch
+		void releasePendingBindings();
+		// decrements m_dispatchDepth and, once the outermost dispatch has
+		// finished, frees the slots of bindings removed during it
+		void endDispatch();
+		// removes a binding and then stops listening for the sender's
+		// destruction if it has no other bindings
+		void removeSignalBindingAndUnbindSender(int bindingId);
+		// removes all bindings from @p sender and all bindings whose context is
+		// @p sender, except those using LazyContextTracking
+		void unbindSender(QObject* sender);
+		// checks up to @p maxBindings binding slots, starting where the
+		// last sweep left off, for bindings whose context has been destroyed
+		void sweepContexts(int maxBindings);
+		void dispatchSignal(int connectionId, void** arguments);
+		void invokeConnection(int connectionId, void** arguments);
 
-		static bool checkTypeMatch(const QtMetacallAdapter& callback, const QList<QByteArray>& paramTypes);
+		// returns the receiver object for connections in a given page
+		// of method IDs
+		QObject* pageReceiver(int page) const;
+		// removes method ID pages at the end which have no connections
+		void trimPages();
+
+		// removes the bindings referred to by @p connections, which must
+		// all belong to this proxy
+		void unbindAll(const Connection* connections, int count);
+
+		// returns the binding referred to by @p connection, or -1 if the
+		// handle is stale or refers to a different proxy
+		int findSignalBinding(const Connection& connection) const;
+
+		// binds a signal which has already been resolved and type-checked
+		// and returns the new binding's ID, or -1 if the binding failed
+		int bindSignal(QObject* sender, const QtSignalTools::SignalDescriptor* descriptor, QObject* context,
+			const QtMetacallAdapter& callback
+		);
+
+		// reserves space for @p count additional signal bindings
+		void reserveSignalBindings(int count);
+
+#ifdef QST_SUPPORTS_TYPED_SIGNALS
+		// binds a signal connected by pointer-to-member, whose types were
+		// checked at compile time
+		Connection bindTypedSignal(QObject* sender, int signalIndex, QObject* context,
+			const QtMetacallAdapter& callback
+		);
+
+		template <class Sender, class SignalClass, class... SignalArgs, class Callback>
+		static QtMetacallAdapter typedSignalAdapter(const Callback& callback)
+		{
+			typedef typename QtSignalTools::ExtractSignature<Callback>::type CallbackSignature;
+			static_assert(QtSignalTools::is_base_of<SignalClass, Sender>::value,
+			  "The signal must belong to the sender's class or one of its base classes");
+			static_assert(QtSignalTools::SignalArgsCompatible<CallbackSignature, void(SignalArgs...)>::value,
+			  "The callback's arguments are not compatible with the signal's arguments");
+			return QtMetacallAdapter::fromImpl<QtSignalTools::TypedSignalAdapterImpl<Callback, SignalArgs...> >(callback);
+		}
+#endif
+
+		static bool checkTypeMatch(const QtMetacallAdapter& callback, const int* paramTypes, int paramCount);
+		// returns the shared proxy which new bindings for @p sender should
+		// be added to
 		static QtSignalForwarder* sharedProxy(QObject* sender);
-		static void invokeBinding(const Binding& binding, void** arguments);
+		static int connectBatch(const QVector<QObject*>& senders, const char* signal, QObject* context,
+			const QVector<QtMetacallAdapter>& callbacks
+		);
+		static void invokeBinding(const Binding& binding, const QtSignalTools::SignalDescriptor* signal,
+			void** arguments
+		);
 
-		// map of sender -> signal binding IDs
-		QMultiHash<QObject*,int> m_senderSignalBindingIds;
+		// map of sender -> signal connection IDs
+		QMultiHash<QObject*,int> m_senderConnectionIds;
 		// map of context -> signal binding IDs
 		QMultiHash<QObject*,int> m_contextBindingIds;
-		// map of binding ID -> binding
-		QHash<int,Binding> m_signalBindings;
-		QHash<QObject*,EventBinding> m_eventBindings;
-
-		// list of available method IDs for new signal
-		// bindings
-		QList<int> m_freeSignalBindingIds;
-
-		// a sentinel callback object for use with the automatically created
-		// bindings to QObject::destroy(QObject*) used to detect when a bound
-		// sender is destroyed
-		static QtMetacallAdapter s_senderDestroyedCallback;
+
+		// signal connections, indexed by connection ID.
+		// Unused slots have a null sender.
+		QVector<SignalConnection> m_signalConnections;
+		SlotMap m_connectionSlots;
+
+		// Qt limits the range of method IDs for each receiver, so connection IDs
+		// are divided into pages with a separate receiver for each page.
+		// The proxy itself is the receiver for the first page.
+		QVector<QtSignalTools::MethodIdPage*> m_extraPages;
+		// number of connections in use in each page
+		QVector<int> m_pageConnectionCounts;
+
+		// signal bindings, indexed by binding ID.
+		// Unused slots have a connection ID of -1.  Bindings are never moved,
+		// so a callback may add or remove bindings while it is running.
+		QtSignalTools::StableArray<Binding> m_signalBindings;
+		SlotMap m_bindingSlots;
+		// IDs of bindings which were removed during dispatch and whose
+		// slots are waiting to be freed
+		QVector<int> m_pendingBindingReleases;
+
+		// map of watched object -> event bindings for that object
+		QHash<QObject*,EventWatch> m_eventBindings;
+		int m_eventBindingCount;
+		// union of the event masks of all watched objects, used to reject
+		// uninteresting events without a hash lookup
+		quint64 m_eventMask;
+		// number of watched objects with each bit set in their event mask
+		int m_eventTypeCounts[64];
+
+		// source of Binding::generation values
+		uint m_lastGeneration;
+
+		ContextTracking m_contextTracking;
+		// next binding slot to check in sweepContexts()
+		int m_sweepCursor;
+		// number of bindings which use LazyContextTracking
+		int m_lazyContextBindingCount;
+		// depth of nested qt_metacall() and eventFilter() calls
+		int m_dispatchDepth;
+
+		// registry which notifies this proxy when senders and contexts
+		// are destroyed
+		QSharedPointer<QtSignalTools::DestructionRegistry> m_destructionRegistry;
+
+		// map of timer ID -> coalesced event binding waiting for delivery
+		QHash<int,QSharedPointer<QtSignalTools::CoalescedEvent> > m_pendingCoalescedEvents;
 };
 
 Q_DECLARE_METATYPE(QtSignalForwarder*)
@@ -117,6 +117,13 @@ class SafeBinder
 		MemberFunc m_func;
 };
 
+// the signature of a SafeBinder is that of the wrapped method, which
+// allows it to be passed directly to QtMetacallAdapter
+template <class Receiver, class MemberFunc>
+struct ExtractSignature<SafeBinder<Receiver,MemberFunc> > : ExtractSignature<MemberFunc>
+{
+};
+
 /** safe_bind() is a wrapper around a method call which does
  * nothing and returns a default value if the object is destroyed
  * before the call is invoked.
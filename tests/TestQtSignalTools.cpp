@@ -42,6 +42,23 @@ struct CallCounter
 	}
 };
 
+// callback factory for use with QtSignalForwarder::connectEach() which
+// returns the same callback for every sender
+template <class Callback>
+struct ConstantFactory
+{
+	ConstantFactory(const Callback& _callback)
+		: callback(_callback)
+	{}
+
+	Callback operator()(QObject*) const
+	{
+		return callback;
+	}
+
+	Callback callback;
+};
+
 struct TestThread : public QThread
 {
 	TestThread(const function<void()>& func, QObject* parent)
@@ -263,22 +280,98 @@ void TestQtSignalTools::testUnbind()
 	QCOMPARE(tester.receiverCount(SIGNAL(destroyed(QObject*))), 0);
 }
 
-void TestQtSignalTools::testProxyBindingLimits()
+void TestQtSignalTools::testManyConnectionsPerProxy()
 {
-	CallbackTester tester;
 	CallCounter counter;
-
-	int bindingCount = 100000;
 	function<void()> incrementFunc = bind(&CallCounter::increment, &counter);
-	for (int i=0; i < bindingCount; i++) {
-		if (!QtSignalForwarder::connect(&tester, SIGNAL(noArgSignal()), incrementFunc)) {
-			// note - we don't use QVERIFY() around the call to QtSignalForwarder::connect() because it
+
+	// bind enough distinct senders to a single proxy to cross the
+	// boundary between the first and second page of method IDs
+	// (8192 connections per page)
+	const int senderCount = 10000;
+	QtSignalForwarder proxy;
+	QVector<CallbackTester*> senders;
+	QVector<QtSignalForwarder::Connection> connections;
+	for (int i=0; i < senderCount; i++) {
+		senders << new CallbackTester;
+		connections << proxy.bind(senders.last(), SIGNAL(noArgSignal()), incrementFunc);
+		if (!connections.last()) {
+			// note - we don't use QVERIFY() around the call to bind() because it
 			// is slow
 			QVERIFY(false);
 		}
 	}
-	tester.emitNoArgSignal();
-	QCOMPARE(counter.count, bindingCount);
+	QCOMPARE(proxy.bindingCount(), senderCount);
+
+	Q_FOREACH(CallbackTester* sender, senders) {
+		sender->emitNoArgSignal();
+	}
+	QCOMPARE(counter.count, senderCount);
+
+	// remove the bindings for the later senders, which use the
+	// additional method ID ranges, and check that the rest still work
+	for (int i = senderCount / 2; i < senderCount; i++) {
+		connections[i].disconnect();
+		if (senders.at(i)->receiverCount(SIGNAL(noArgSignal())) != 0) {
+			QVERIFY(false);
+		}
+	}
+	counter.count = 0;
+	Q_FOREACH(CallbackTester* sender, senders) {
+		sender->emitNoArgSignal();
+	}
+	QCOMPARE(counter.count, senderCount / 2);
+
+	// re-use the released connections
+	for (int i = senderCount / 2; i < senderCount; i++) {
+		proxy.bind(senders.at(i), SIGNAL(noArgSignal()), incrementFunc);
+	}
+	counter.count = 0;
+	Q_FOREACH(CallbackTester* sender, senders) {
+		sender->emitNoArgSignal();
+	}
+	QCOMPARE(counter.count, senderCount);
+
+	qDeleteAll(senders);
+	QCOMPARE(proxy.bindingCount(), 0);
+}
+
+void TestQtSignalTools::testProxyScalingPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// measure the cost of binding, emitting and removing bindings on a
+	// single proxy as the number of (sender, signal) pairs grows
+	CallCounter counter;
+	function<void()> incrementFunc = bind(&CallCounter::increment, &counter);
+
+	for (int senderCount = 1000; senderCount <= 256000; senderCount *= 2) {
+		QVector<CallbackTester*> senders;
+		for (int i=0; i < senderCount; i++) {
+			senders << new CallbackTester;
+		}
+
+		QtSignalForwarder proxy;
+		QElapsedTimer timer;
+		timer.start();
+		Q_FOREACH(CallbackTester* sender, senders) {
+			proxy.bind(sender, SIGNAL(noArgSignal()), incrementFunc);
+		}
+		qint64 bindNs = timer.nsecsElapsed();
+		Q_FOREACH(CallbackTester* sender, senders) {
+			sender->emitNoArgSignal();
+		}
+		qint64 emitNs = timer.nsecsElapsed() - bindNs;
+		qDeleteAll(senders);
+		qint64 destroyNs = timer.nsecsElapsed() - emitNs - bindNs;
+
+		qDebug() << "per sender with" << senderCount << "senders: bind" << (bindNs / senderCount) << "ns"
+		  << "emit" << (emitNs / senderCount) << "ns"
+		  << "destroy" << (destroyNs / senderCount) << "ns";
+		QCOMPARE(proxy.bindingCount(), 0);
+	}
+#endif
 }
 
 void TestQtSignalTools::testConnectPerf()
@@ -316,6 +409,111 @@ void TestQtSignalTools::testConnectPerf()
 #endif
 }
 
+void TestQtSignalTools::testConnectEachPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	CallbackTester receiver;
+	function<void(int)> callback = bind(&CallbackTester::addValue, &receiver, 42);
+
+	int objCount = 2;
+
+	for (int i = 0; i < 15; i++) {
+		qDebug() << "testing with step" << i;
+		QElapsedTimer timer;
+		timer.start();
+
+		QVector<CallbackTester*> objectList;
+		for (int k=0; k < objCount; k++) {
+			objectList << new CallbackTester;
+		}
+		int connected = QtSignalForwarder::connectEach(objectList.constBegin(), objectList.constEnd(),
+		  SIGNAL(aSignal(int)), ConstantFactory<function<void(int)> >(callback));
+		if (connected != objCount) {
+			qWarning() << "Failed to connect signal";
+		}
+		Q_FOREACH(CallbackTester* object, objectList) {
+			object->emitASignal(32);
+		}
+		qDeleteAll(objectList);
+		objectList.clear();
+
+		qreal totalMs = timer.nsecsElapsed() / (1000 * 1000);
+		qreal meanMs = totalMs/objCount;
+		qDebug() << "cost per obj for" << objCount << "objects" << meanMs << "total" << totalMs;
+
+		objCount *= 2;
+	}
+#endif
+}
+
+void TestQtSignalTools::testEmitPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	CallCounter counter;
+	function<void()> incrementFunc = bind(&CallCounter::increment, &counter);
+
+	// fill a single proxy with signal bindings and measure the cost
+	// of dispatching emissions to them
+	const int bindingCount = 10000;
+	const int emitCount = 100;
+
+	QtSignalForwarder proxy;
+	QVector<CallbackTester*> senders;
+	for (int i=0; i < bindingCount; i++) {
+		senders << new CallbackTester;
+		proxy.bind(senders.last(), SIGNAL(noArgSignal()), incrementFunc);
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0; i < emitCount; i++) {
+		Q_FOREACH(CallbackTester* sender, senders) {
+			sender->emitNoArgSignal();
+		}
+	}
+	qint64 totalNs = timer.nsecsElapsed();
+	qDebug() << "cost per emit with" << bindingCount << "bindings" << (totalNs / (bindingCount * emitCount)) << "ns"
+	  << "total" << (totalNs / (1000 * 1000)) << "ms";
+
+	QCOMPARE(counter.count, bindingCount * emitCount);
+	qDeleteAll(senders);
+#endif
+}
+
+void TestQtSignalTools::testSignalIndexCachePerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	const int connectCount = 20000;
+	CallbackTester sender;
+	QtSignalForwarder proxy;
+
+	for (int pass=0; pass < 2; pass++) {
+		bool warm = pass > 0;
+		qint64 totalNs = 0;
+		for (int i=0; i < connectCount; i++) {
+			if (!warm) {
+				QtSignalForwarder::clearSignalIndexCache();
+			}
+			QElapsedTimer timer;
+			timer.start();
+			// use a non-normalized signature so that a cold lookup
+			// has to normalize it
+			proxy.bind(&sender, SIGNAL(stringSignal(const QString&)), noArgsFunc);
+			totalNs += timer.nsecsElapsed();
+			proxy.unbind(&sender);
+		}
+		qDebug() << "cost per connect with" << (warm ? "warm" : "cold") << "signal index cache"
+		  << (totalNs / connectCount) << "ns";
+	}
+#endif
+}
+
 void TestQtSignalTools::testDelayedCall()
 {
 #if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
@@ -479,7 +677,8 @@ void TestQtSignalTools::testContextDestroyed()
 	);
 	QCOMPARE(TestRef::s_count, 2);
 	QCOMPARE(x, 0);
-	QCOMPARE(tester.receiverCount(SIGNAL(noArgSignal())), 2);
+	// both bindings share a single Qt connection
+	QCOMPARE(tester.receiverCount(SIGNAL(noArgSignal())), 1);
 	tester.emitNoArgSignal();
 	QCOMPARE(x, 2);
 	delete context;
@@ -538,4 +737,1950 @@ void TestQtSignalTools::testThread()
 	QVERIFY(t2.wait());
 }
 
+void TestQtSignalTools::testSignalIndexCache()
+{
+	CallbackTester sender1;
+	CallbackTester sender2;
+	QtSignalForwarder proxy;
+
+	QVERIFY(proxy.bind(&sender1, SIGNAL(stringSignal(const QString&)), noArgsFunc));
+	QtSignalForwarder::SignalIndexCacheStats stats = QtSignalForwarder::signalIndexCacheStats();
+
+	// binding the same signal on another object of the same class
+	// should be resolved from the cache
+	QVERIFY(proxy.bind(&sender2, SIGNAL(stringSignal(const QString&)), noArgsFunc));
+	QtSignalForwarder::SignalIndexCacheStats newStats = QtSignalForwarder::signalIndexCacheStats();
+	QCOMPARE(newStats.misses, stats.misses);
+	QVERIFY(newStats.hits > stats.hits);
+
+	// failed lookups for unknown signals are not cached
+	QVERIFY(!proxy.bind(&sender1, SIGNAL(noSuchSignal()), noArgsFunc));
+	QVERIFY(!proxy.bind(&sender2, SIGNAL(noSuchSignal()), noArgsFunc));
+	QCOMPARE(QtSignalForwarder::signalIndexCacheStats().misses, newStats.misses + 2);
+	QCOMPARE(QtSignalForwarder::signalIndexCacheStats().size, newStats.size);
+
+	proxy.unbind(&sender1, SIGNAL(stringSignal(const QString&)));
+	sender1.emitStringSignal("test");
+	QCOMPARE(proxy.bindingCount(), 1);
+
+	QtSignalForwarder::clearSignalIndexCache();
+	stats = QtSignalForwarder::signalIndexCacheStats();
+	QCOMPARE(stats.hits, 0);
+	QCOMPARE(stats.misses, 0);
+	QCOMPARE(stats.size, 0);
+}
+
+QtCallback addValueCallback(CallbackTester* tester)
+{
+	return QtCallback(tester, SLOT(addValue(int)));
+}
+
+void TestQtSignalTools::testConnectEach()
+{
+	QList<CallbackTester*> senders;
+	for (int i=0; i < 50; i++) {
+		senders << new CallbackTester;
+	}
+	QObject* context = new QObject;
+
+	QCOMPARE(QtSignalForwarder::connectEach(senders.begin(), senders.end(),
+	  SIGNAL(aSignal(int)), context, addValueCallback), senders.count());
+	for (int i=0; i < senders.count(); i++) {
+		senders.at(i)->emitASignal(i);
+		QCOMPARE(senders.at(i)->values, QList<int>() << i);
+	}
+
+	// senders whose callbacks do not match the signal are skipped
+	QCOMPARE(QtSignalForwarder::connectEach(senders.begin(), senders.end(),
+	  SIGNAL(noArgSignal()), addValueCallback), 0);
+
+	// a signal which does not exist connects none of the senders
+	QCOMPARE(QtSignalForwarder::connectEach(senders.begin(), senders.end(),
+	  SIGNAL(noSuchSignal(int)), addValueCallback), 0);
+
+	// destroying the context removes all of the bindings
+	delete context;
+	Q_FOREACH(CallbackTester* sender, senders) {
+		sender->values.clear();
+		sender->emitASignal(1);
+		QCOMPARE(sender->values, QList<int>());
+	}
+	qDeleteAll(senders);
+}
+
+void appendValue(QList<int>* list, int value)
+{
+	list->append(value);
+}
+
+void deleteObject(QObject* object)
+{
+	delete object;
+}
+
+void TestQtSignalTools::testSignalFanOut()
+{
+	CallbackTester tester;
+	QtSignalForwarder proxy;
+	QList<int> calls;
+
+	QObject* context = new QObject;
+	proxy.bind(&tester, SIGNAL(noArgSignal()), function<void()>(bind(appendValue, &calls, 1)));
+	proxy.bind(&tester, SIGNAL(noArgSignal()), context, function<void()>(bind(appendValue, &calls, 2)));
+	proxy.bind(&tester, SIGNAL(noArgSignal()), function<void()>(bind(appendValue, &calls, 3)));
+	QCOMPARE(proxy.bindingCount(), 3);
+
+	// all callbacks for a (sender, signal) pair share one Qt connection
+	// and are invoked in the order they were bound
+	QCOMPARE(tester.receiverCount(SIGNAL(noArgSignal())), 1);
+	tester.emitNoArgSignal();
+	QCOMPARE(calls, QList<int>() << 1 << 2 << 3);
+	calls.clear();
+
+	delete context;
+	QCOMPARE(proxy.bindingCount(), 2);
+	tester.emitNoArgSignal();
+	QCOMPARE(calls, QList<int>() << 1 << 3);
+	calls.clear();
+
+	// a callback which removes a later binding for the same signal
+	// during dispatch prevents it from being invoked
+	QObject* laterContext = new QObject;
+	proxy.bind(&tester, SIGNAL(aSignal(int)), function<void()>(bind(deleteObject, laterContext)));
+	proxy.bind(&tester, SIGNAL(aSignal(int)), function<void()>(bind(appendValue, &calls, 4)));
+	proxy.bind(&tester, SIGNAL(aSignal(int)), laterContext, function<void()>(bind(appendValue, &calls, 5)));
+	proxy.unbind(&tester, SIGNAL(noArgSignal()));
+	QCOMPARE(tester.receiverCount(SIGNAL(noArgSignal())), 0);
+	QCOMPARE(tester.receiverCount(SIGNAL(aSignal(int))), 1);
+	tester.emitASignal(0);
+	QCOMPARE(calls, QList<int>() << 4 << 5);
+	calls.clear();
+
+	proxy.unbind(&tester);
+	QCOMPARE(proxy.bindingCount(), 0);
+	QCOMPARE(tester.receiverCount(SIGNAL(aSignal(int))), 0);
+}
+
+void TestQtSignalTools::testConnectionHandle()
+{
+	CallbackTester tester;
+	QList<int> calls;
+
+	QtSignalForwarder::Connection invalid;
+	QVERIFY(!invalid);
+	QVERIFY(!invalid.isConnected());
+	invalid.disconnect();
+
+	QScopedPointer<QtSignalForwarder> proxy(new QtSignalForwarder);
+	QtSignalForwarder::Connection first = proxy->bind(&tester, SIGNAL(noArgSignal()),
+	  function<void()>(bind(appendValue, &calls, 1)));
+	QtSignalForwarder::Connection second = proxy->bind(&tester, SIGNAL(noArgSignal()),
+	  function<void()>(bind(appendValue, &calls, 2)));
+	QVERIFY(first);
+	QVERIFY(first.isConnected());
+	QVERIFY(proxy->isConnected(first));
+	QVERIFY(!QtSignalForwarder().isConnected(first));
+
+	// disconnecting one handle leaves other bindings for
+	// the same signal intact
+	first.disconnect();
+	QVERIFY(first);
+	QVERIFY(!first.isConnected());
+	QVERIFY(second.isConnected());
+	QCOMPARE(proxy->bindingCount(), 1);
+	tester.emitNoArgSignal();
+	QCOMPARE(calls, QList<int>() << 2);
+	calls.clear();
+
+	// a stale handle must not remove a new binding which re-uses its slot
+	QtSignalForwarder::Connection third = proxy->bind(&tester, SIGNAL(noArgSignal()),
+	  function<void()>(bind(appendValue, &calls, 3)));
+	first.disconnect();
+	QVERIFY(third.isConnected());
+	QCOMPARE(proxy->bindingCount(), 2);
+
+	// removing the last binding for a sender disconnects
+	// it from the proxy completely
+	second.disconnect();
+	QtSignalForwarder::disconnect(third);
+	QCOMPARE(proxy->bindingCount(), 0);
+	QVERIFY(!proxy->isConnected(&tester));
+	QCOMPARE(tester.receiverCount(SIGNAL(noArgSignal())), 0);
+	QCOMPARE(tester.receiverCount(SIGNAL(destroyed(QObject*))), 0);
+
+	// handles become stale when the sender or the proxy is destroyed
+	CallbackTester* sender = new CallbackTester;
+	QtSignalForwarder::Connection senderHandle = proxy->bind(sender, SIGNAL(noArgSignal()), noArgsFunc);
+	delete sender;
+	QVERIFY(!senderHandle.isConnected());
+	senderHandle.disconnect();
+
+	QtSignalForwarder::Connection proxyHandle = proxy->bind(&tester, SIGNAL(noArgSignal()), noArgsFunc);
+	proxy.reset();
+	QVERIFY(!proxyHandle.isConnected());
+	proxyHandle.disconnect();
+
+	// a failed connection returns a null handle
+	QVERIFY(!QtSignalForwarder::connect(&tester, SIGNAL(noArgSignal()), intFunc));
+
+	QtSignalForwarder::Connection shared = QtSignalForwarder::connect(&tester, SIGNAL(noArgSignal()),
+	  function<void()>(bind(appendValue, &calls, 4)));
+	tester.emitNoArgSignal();
+	shared.disconnect();
+	tester.emitNoArgSignal();
+	QCOMPARE(calls, QList<int>() << 4);
+}
+
+void TestQtSignalTools::testConnectionHandlePerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// simulates a view which connects a callback for each visible row
+	// and disconnects them again as rows scroll out of view
+	const int senderCount = 100;
+	const int bindingsPerSender = 20;
+	const int iterations = 100;
+
+	QVector<CallbackTester*> senders;
+	for (int i=0; i < senderCount; i++) {
+		senders << new CallbackTester;
+	}
+
+	QtSignalForwarder proxy;
+	QVector<QtSignalForwarder::Connection> connections;
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0; i < iterations; i++) {
+		Q_FOREACH(CallbackTester* sender, senders) {
+			for (int k=0; k < bindingsPerSender; k++) {
+				connections << proxy.bind(sender, SIGNAL(noArgSignal()), noArgsFunc);
+			}
+		}
+		Q_FOREACH(QtSignalForwarder::Connection connection, connections) {
+			connection.disconnect();
+		}
+		connections.clear();
+	}
+	qint64 totalNs = timer.nsecsElapsed();
+	int total = senderCount * bindingsPerSender * iterations;
+	qDebug() << "cost per bind/disconnect" << (totalNs / total) << "ns"
+	  << "total" << (totalNs / (1000 * 1000)) << "ms";
+
+	QCOMPARE(proxy.bindingCount(), 0);
+	qDeleteAll(senders);
+#endif
+}
+
+void TestQtSignalTools::testConnectionGroup()
+{
+	CallbackTester tester;
+	CallbackTester otherTester;
+	QList<int> calls;
+	QtSignalForwarder proxy;
+	QtSignalForwarder otherProxy;
+
+	QtSignalForwarder::Connection outside = proxy.bind(&tester, SIGNAL(noArgSignal()),
+	  function<void()>(bind(appendValue, &calls, 0)));
+	{
+		QtSignalForwarder::ConnectionGroup group;
+		group.add(proxy.bind(&tester, SIGNAL(noArgSignal()), function<void()>(bind(appendValue, &calls, 1))));
+		group.add(proxy.bind(&tester, SIGNAL(aSignal(int)), function<void()>(bind(appendValue, &calls, 2))));
+		group.add(proxy.bind(&otherTester, SIGNAL(noArgSignal()), function<void()>(bind(appendValue, &calls, 3))));
+		group.add(otherProxy.bind(&tester, SIGNAL(noArgSignal()), function<void()>(bind(appendValue, &calls, 4))));
+		group.connect(&otherTester, SIGNAL(aSignal(int)), function<void()>(bind(appendValue, &calls, 5)));
+
+		// null handles are not added and handles which are removed by other
+		// means are ignored when the group is destroyed
+		group.add(QtSignalForwarder::Connection());
+		QtSignalForwarder::Connection removed = proxy.bind(&tester, SIGNAL(noArgSignal()), noArgsFunc);
+		group.add(removed);
+		removed.disconnect();
+		QCOMPARE(group.count(), 6);
+
+		tester.emitNoArgSignal();
+		tester.emitASignal(0);
+		otherTester.emitNoArgSignal();
+		otherTester.emitASignal(0);
+		QCOMPARE(calls, QList<int>() << 0 << 1 << 4 << 2 << 3 << 5);
+		calls.clear();
+	}
+
+	// only the binding made outside the group remains
+	QVERIFY(outside.isConnected());
+	QCOMPARE(proxy.bindingCount(), 1);
+	QCOMPARE(otherProxy.bindingCount(), 0);
+	QVERIFY(!proxy.isConnected(&otherTester));
+	QVERIFY(!otherProxy.isConnected(&tester));
+	QCOMPARE(tester.receiverCount(SIGNAL(noArgSignal())), 1);
+	QCOMPARE(tester.receiverCount(SIGNAL(aSignal(int))), 0);
+	QCOMPARE(otherTester.receiverCount(SIGNAL(noArgSignal())), 0);
+	QCOMPARE(otherTester.receiverCount(SIGNAL(aSignal(int))), 0);
+	QCOMPARE(otherTester.receiverCount(SIGNAL(destroyed(QObject*))), 0);
+
+	tester.emitNoArgSignal();
+	otherTester.emitASignal(0);
+	QCOMPARE(calls, QList<int>() << 0);
+
+	// a group may outlive the proxies and senders of its bindings
+	QtSignalForwarder::ConnectionGroup group;
+	QtSignalForwarder* tempProxy = new QtSignalForwarder;
+	CallbackTester* tempSender = new CallbackTester;
+	group.add(tempProxy->bind(&tester, SIGNAL(noArgSignal()), noArgsFunc));
+	group.add(proxy.bind(tempSender, SIGNAL(noArgSignal()), noArgsFunc));
+	delete tempProxy;
+	delete tempSender;
+	group.disconnectAll();
+	QCOMPARE(group.count(), 0);
+	QCOMPARE(proxy.bindingCount(), 1);
+}
+
+void TestQtSignalTools::testConnectionGroupPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// compare the cost of tearing down the bindings for a set of
+	// senders by destroying the senders with the cost of disconnecting
+	// a group first
+	const int senderCount = 4000;
+	const int bindingsPerSender = 2;
+
+	for (int pass=0; pass < 2; pass++) {
+		bool useGroup = pass == 1;
+		QtSignalForwarder proxy;
+		QVector<CallbackTester*> senders;
+		QtSignalForwarder::ConnectionGroup group;
+		for (int i=0; i < senderCount; i++) {
+			CallbackTester* sender = new CallbackTester;
+			senders << sender;
+			group.add(proxy.bind(sender, SIGNAL(noArgSignal()), noArgsFunc));
+			group.add(proxy.bind(sender, SIGNAL(aSignal(int)), noArgsFunc));
+		}
+
+		QElapsedTimer timer;
+		timer.start();
+		if (useGroup) {
+			group.disconnectAll();
+		}
+		qDeleteAll(senders);
+		qint64 totalNs = timer.nsecsElapsed();
+		qDebug() << (useGroup ? "group teardown" : "per-sender teardown")
+		  << "cost per binding" << (totalNs / (senderCount * bindingsPerSender)) << "ns"
+		  << "total" << (totalNs / (1000 * 1000)) << "ms";
+		QCOMPARE(proxy.bindingCount(), 0);
+	}
+#endif
+}
+
+struct SharedProxyTestResult
+{
+	SharedProxyTestResult()
+		: received(0)
+		, receivedAfterDisconnect(0)
+	{}
+
+	int received;
+	int receivedAfterDisconnect;
+};
+
+void connectManyFromThread(SharedProxyTestResult* result, int senderCount)
+{
+	CallCounter counter;
+	function<void()> incrementFunc = bind(&CallCounter::increment, &counter);
+
+	QList<CallbackTester*> senders;
+	for (int i=0; i < senderCount; i++) {
+		senders << new CallbackTester;
+		QtSignalForwarder::connect(senders.last(), SIGNAL(noArgSignal()), incrementFunc);
+		QtSignalForwarder::connect(senders.last(), SIGNAL(aSignal(int)), incrementFunc);
+	}
+	Q_FOREACH(CallbackTester* sender, senders) {
+		sender->emitNoArgSignal();
+		sender->emitASignal(0);
+	}
+	result->received = counter.count;
+
+	// disconnect() must find each sender's bindings regardless
+	// of which shared proxy they were added to
+	counter.count = 0;
+	Q_FOREACH(CallbackTester* sender, senders) {
+		QtSignalForwarder::disconnect(sender, SIGNAL(noArgSignal()));
+		sender->emitNoArgSignal();
+		sender->emitASignal(0);
+	}
+	result->receivedAfterDisconnect = counter.count;
+	qDeleteAll(senders);
+}
+
+void TestQtSignalTools::testSharedProxyCount()
+{
+	const int defaultCount = QtSignalForwarder::sharedProxyCount();
+	QVERIFY(defaultCount > 0);
+
+	// the shard count applies to threads which have not
+	// used the shared proxies yet
+	const int senderCount = 200;
+	int shardCounts[] = { 1, 3, 16 };
+	for (int i=0; i < 3; i++) {
+		QtSignalForwarder::setSharedProxyCount(shardCounts[i]);
+		QCOMPARE(QtSignalForwarder::sharedProxyCount(), shardCounts[i]);
+
+		SharedProxyTestResult result;
+		TestThread thread(bind(connectManyFromThread, &result, senderCount), 0);
+		thread.start();
+		QVERIFY(thread.wait());
+		QCOMPARE(result.received, senderCount * 2);
+		QCOMPARE(result.receivedAfterDisconnect, senderCount);
+	}
+	QtSignalForwarder::setSharedProxyCount(defaultCount);
+}
+
+struct CompactTestResult
+{
+	CompactTestResult()
+		: staleHandleConnected(true)
+		, received(0)
+	{}
+
+	bool staleHandleConnected;
+	int received;
+};
+
+void compactFromThread(CompactTestResult* result)
+{
+	CallCounter counter;
+	function<void()> incrementFunc = bind(&CallCounter::increment, &counter);
+
+	// use enough senders to need more than one range of method IDs,
+	// then remove all of the bindings and compact the now-empty proxy
+	const int senderCount = 6000;
+	QList<CallbackTester*> senders;
+	QList<QtSignalForwarder::Connection> connections;
+	for (int i=0; i < senderCount; i++) {
+		senders << new CallbackTester;
+		connections << QtSignalForwarder::connect(senders.last(), SIGNAL(noArgSignal()), incrementFunc);
+	}
+	qDeleteAll(senders);
+	senders.clear();
+	QtSignalForwarder::compact();
+
+	// handles from before compaction must stay stale after their
+	// binding slots have been released and re-used
+	for (int i=0; i < senderCount; i++) {
+		senders << new CallbackTester;
+		QtSignalForwarder::connect(senders.last(), SIGNAL(noArgSignal()), incrementFunc);
+	}
+	result->staleHandleConnected = false;
+	Q_FOREACH(QtSignalForwarder::Connection connection, connections) {
+		if (connection.isConnected()) {
+			result->staleHandleConnected = true;
+		}
+		connection.disconnect();
+	}
+	Q_FOREACH(CallbackTester* sender, senders) {
+		sender->emitNoArgSignal();
+	}
+	result->received = counter.count;
+	qDeleteAll(senders);
+	QtSignalForwarder::compact();
+}
+
+void TestQtSignalTools::testCompact()
+{
+	const int defaultCount = QtSignalForwarder::sharedProxyCount();
+	QtSignalForwarder::setSharedProxyCount(1);
+
+	CompactTestResult result;
+	TestThread thread(bind(compactFromThread, &result), 0);
+	thread.start();
+	QVERIFY(thread.wait());
+	QVERIFY(!result.staleHandleConnected);
+	QCOMPARE(result.received, 6000);
+
+	QtSignalForwarder::setSharedProxyCount(defaultCount);
+}
+
+void connectPerfFromThread(int senderCount)
+{
+	function<void()> callback = noArgsFunc;
+
+	QElapsedTimer timer;
+	timer.start();
+	QVector<CallbackTester*> senders;
+	for (int i=0; i < senderCount; i++) {
+		senders << new CallbackTester;
+		QtSignalForwarder::connect(senders.last(), SIGNAL(noArgSignal()), callback);
+	}
+	qint64 connectNs = timer.nsecsElapsed();
+	Q_FOREACH(CallbackTester* sender, senders) {
+		sender->emitNoArgSignal();
+	}
+	qint64 emitNs = timer.nsecsElapsed() - connectNs;
+	Q_FOREACH(CallbackTester* sender, senders) {
+		QtSignalForwarder::disconnect(sender, SIGNAL(noArgSignal()));
+	}
+	qint64 disconnectNs = timer.nsecsElapsed() - emitNs - connectNs;
+	qDeleteAll(senders);
+
+	qDebug() << "  per sender: connect" << (connectNs / senderCount) << "ns"
+	  << "emit" << (emitNs / senderCount) << "ns"
+	  << "disconnect" << (disconnectNs / senderCount) << "ns";
+}
+
+void TestQtSignalTools::testSharedProxyCountPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	const int defaultCount = QtSignalForwarder::sharedProxyCount();
+	const int senderCount = 4000;
+	for (int shardCount = 1; shardCount <= 64; shardCount *= 2) {
+		qDebug() << "testing with" << shardCount << "shared proxies per thread";
+		QtSignalForwarder::setSharedProxyCount(shardCount);
+
+		// each configuration is run in a new thread so that it
+		// starts with an empty pool of shared proxies
+		TestThread thread(bind(connectPerfFromThread, senderCount), 0);
+		thread.start();
+		QVERIFY(thread.wait());
+	}
+	QtSignalForwarder::setSharedProxyCount(defaultCount);
+#endif
+}
+
+void appendObjectName(QList<QString>* list, QObject* object)
+{
+	list->append(object->objectName());
+}
+
+// replaces the Enter binding for CallbackTester with a binding of @p callback
+// to @p event, or with nothing if @p event is QEvent::None
+void rebindClassEvent(QEvent::Type event, const function<void(QObject*)>& callback)
+{
+	QtSignalForwarder::disconnect(&CallbackTester::staticMetaObject, QEvent::Enter);
+	if (event != QEvent::None) {
+		QtSignalForwarder::connect(&CallbackTester::staticMetaObject, event, callback);
+	}
+}
+
+void appendString(QList<QString>* list, const QString& value)
+{
+	list->append(value);
+}
+
+void deleteProxy(QtSignalForwarder** proxy)
+{
+	delete *proxy;
+	*proxy = 0;
+}
+
+void TestQtSignalTools::testDestructionRegistry()
+{
+	CallbackTester* sender = new CallbackTester;
+	sender->setObjectName("sender");
+	QObject* context = new QObject;
+	QtSignalForwarder proxy;
+	QtSignalForwarder otherProxy;
+
+	// each object has a single destruction hook, regardless of how many
+	// proxies and bindings refer to it
+	proxy.bind(sender, SIGNAL(noArgSignal()), noArgsFunc);
+	proxy.bind(sender, SIGNAL(aSignal(int)), noArgsFunc);
+	otherProxy.bind(sender, SIGNAL(noArgSignal()), context, noArgsFunc);
+	QtSignalForwarder::connect(sender, SIGNAL(noArgSignal()), context, noArgsFunc);
+	QCOMPARE(sender->receiverCount(SIGNAL(destroyed(QObject*))), 1);
+	QCOMPARE(sender->receiverCount(SIGNAL(noArgSignal())), 3);
+	QCOMPARE(proxy.bindingCount(), 2);
+
+	// bindings to the destroyed() signal itself are invoked before the
+	// sender's bindings are removed
+	QList<QString> destroyedNames;
+	proxy.bind(sender, SIGNAL(destroyed(QObject*)), function<void(QObject*)>(bind(appendObjectName, &destroyedNames, _1)));
+	otherProxy.bind(sender, SIGNAL(destroyed()), function<void()>(bind(appendString, &destroyedNames, QString("no args"))));
+	QCOMPARE(sender->receiverCount(SIGNAL(destroyed(QObject*))), 1);
+
+	// removing one proxy's bindings leaves the hook in place for the others
+	proxy.unbind(sender, SIGNAL(aSignal(int)));
+	QCOMPARE(sender->receiverCount(SIGNAL(destroyed(QObject*))), 1);
+
+	delete sender;
+	QCOMPARE(destroyedNames, QList<QString>() << "sender" << "no args");
+	QCOMPARE(proxy.bindingCount(), 0);
+	QCOMPARE(otherProxy.bindingCount(), 0);
+	QVERIFY(!otherProxy.isConnected(context));
+
+	// the context's hook is removed once no bindings refer to it
+	CallbackTester tester;
+	QtSignalForwarder::Connection connection = proxy.bind(&tester, SIGNAL(noArgSignal()), context, noArgsFunc);
+	proxy.bind(&tester, SIGNAL(noArgSignal()), noArgsFunc);
+	QCOMPARE(tester.receiverCount(SIGNAL(destroyed(QObject*))), 1);
+	connection.disconnect();
+	QCOMPARE(proxy.bindingCount(), 1);
+	delete context;
+	QCOMPARE(proxy.bindingCount(), 1);
+	proxy.unbind(&tester);
+	QCOMPARE(tester.receiverCount(SIGNAL(destroyed(QObject*))), 0);
+
+	// a proxy destroyed by another proxy's callback while the registry is
+	// notifying watchers of a sender's destruction is not notified
+	sender = new CallbackTester;
+	QtSignalForwarder* doomedProxy = new QtSignalForwarder;
+	proxy.bind(sender, SIGNAL(destroyed()), function<void()>(bind(deleteProxy, &doomedProxy)));
+	doomedProxy->bind(sender, SIGNAL(destroyed()), noArgsFunc);
+	delete sender;
+	QVERIFY(!doomedProxy);
+	QCOMPARE(proxy.bindingCount(), 0);
+}
+
+void TestQtSignalTools::testLazyContextTracking()
+{
+	CallbackTester tester;
+	QList<int> calls;
+	QtSignalForwarder proxy;
+	QCOMPARE(proxy.contextTracking(), QtSignalForwarder::EagerContextTracking);
+	proxy.setContextTracking(QtSignalForwarder::LazyContextTracking);
+
+	// contexts are not watched for destruction
+	CallbackTester* context = new CallbackTester;
+	QObject* otherContext = new QObject;
+	proxy.bind(&tester, SIGNAL(noArgSignal()), context, function<void()>(bind(appendValue, &calls, 1)));
+	proxy.bind(&tester, SIGNAL(noArgSignal()), otherContext, function<void()>(bind(appendValue, &calls, 2)));
+	QCOMPARE(context->receiverCount(SIGNAL(destroyed(QObject*))), 0);
+
+	// bindings with a destroyed context are skipped and removed when
+	// the signal is emitted
+	delete context;
+	QCOMPARE(proxy.bindingCount(), 2);
+	tester.emitNoArgSignal();
+	QCOMPARE(calls, QList<int>() << 2);
+	QCOMPARE(proxy.bindingCount(), 1);
+
+	delete otherContext;
+	tester.emitNoArgSignal();
+	QCOMPARE(calls, QList<int>() << 2);
+	QCOMPARE(proxy.bindingCount(), 0);
+	QVERIFY(!proxy.isConnected(&tester));
+	QCOMPARE(tester.receiverCount(SIGNAL(noArgSignal())), 0);
+	QCOMPARE(tester.receiverCount(SIGNAL(destroyed(QObject*))), 0);
+
+	// bindings whose signals are not emitted are reclaimed by an
+	// incremental sweep as further bindings are added
+	const int contextCount = 100;
+	QList<QObject*> contexts;
+	for (int i=0; i < contextCount; i++) {
+		contexts << new QObject;
+		proxy.bind(&tester, SIGNAL(aSignal(int)), contexts.last(), noArgsFunc);
+	}
+	qDeleteAll(contexts);
+	contexts.clear();
+	QCOMPARE(proxy.bindingCount(), contextCount);
+
+	QObject liveContext;
+	for (int i=0; i < contextCount; i++) {
+		proxy.bind(&tester, SIGNAL(noArgSignal()), &liveContext, noArgsFunc);
+	}
+	QCOMPARE(proxy.bindingCount(), contextCount);
+	QCOMPARE(tester.receiverCount(SIGNAL(aSignal(int))), 0);
+
+	// or explicitly
+	CallbackTester otherTester;
+	contexts << new QObject << new QObject;
+	proxy.bind(&otherTester, SIGNAL(noArgSignal()), contexts.at(0), noArgsFunc);
+	proxy.bind(&otherTester, SIGNAL(aSignal(int)), contexts.at(1), noArgsFunc);
+	qDeleteAll(contexts);
+	proxy.sweepContexts();
+	QCOMPARE(proxy.bindingCount(), contextCount);
+	QVERIFY(!proxy.isConnected(&otherTester));
+
+	// switching back only affects new bindings
+	proxy.setContextTracking(QtSignalForwarder::EagerContextTracking);
+	QObject* eagerContext = new QObject;
+	proxy.bind(&tester, SIGNAL(noArgSignal()), eagerContext, noArgsFunc);
+	QCOMPARE(proxy.bindingCount(), contextCount + 1);
+	delete eagerContext;
+	QCOMPARE(proxy.bindingCount(), contextCount);
+
+	// unbinding a context removes the lazily tracked bindings which use it
+	proxy.unbind(&liveContext);
+	QCOMPARE(proxy.bindingCount(), 0);
+	QVERIFY(!proxy.isConnected(&tester));
+}
+
+void TestQtSignalTools::testEventFilterMask()
+{
+	CallbackTester tester;
+	CallCounter firstTypeCall;
+	CallCounter collidingTypeCall;
+	CallCounter enterCall;
+
+	// event types which map to the same bit in the event mask
+	QEvent::Type firstType = static_cast<QEvent::Type>(QEvent::User);
+	QEvent::Type collidingType = static_cast<QEvent::Type>(QEvent::User + 64);
+
+	QtSignalForwarder forwarder;
+	forwarder.bind(&tester, firstType, incrementFunc(firstTypeCall));
+	forwarder.bind(&tester, collidingType, incrementFunc(collidingTypeCall));
+	forwarder.bind(&tester, QEvent::Enter, incrementFunc(enterCall));
+	QCOMPARE(forwarder.bindingCount(), 3);
+
+	QEvent firstEvent(firstType);
+	QEvent collidingEvent(collidingType);
+	QEvent enterEvent(QEvent::Enter);
+	QEvent leaveEvent(QEvent::Leave);
+	QCoreApplication::sendEvent(&tester, &firstEvent);
+	QCoreApplication::sendEvent(&tester, &leaveEvent);
+	QCOMPARE(firstTypeCall.count, 1);
+	QCOMPARE(collidingTypeCall.count, 0);
+	QCOMPARE(enterCall.count, 0);
+
+	// removing one of the event types sharing a bit must not
+	// remove the other from the mask
+	forwarder.unbind(&tester, firstType);
+	QCOMPARE(forwarder.bindingCount(), 2);
+	QCoreApplication::sendEvent(&tester, &firstEvent);
+	QCoreApplication::sendEvent(&tester, &collidingEvent);
+	QCoreApplication::sendEvent(&tester, &enterEvent);
+	QCOMPARE(firstTypeCall.count, 1);
+	QCOMPARE(collidingTypeCall.count, 1);
+	QCOMPARE(enterCall.count, 1);
+
+	// events for one watched object must not trigger bindings
+	// for another with the same event type
+	CallbackTester otherTester;
+	CallCounter otherEnterCall;
+	forwarder.bind(&otherTester, QEvent::Enter, incrementFunc(otherEnterCall));
+	QCoreApplication::sendEvent(&otherTester, &enterEvent);
+	QCOMPARE(enterCall.count, 1);
+	QCOMPARE(otherEnterCall.count, 1);
+
+	// callbacks may remove bindings for the event being delivered
+	function<void()> unbindFunc = bind(static_cast<void(QtSignalForwarder::*)(QObject*)>(&QtSignalForwarder::unbind),
+	  &forwarder, &otherTester);
+	forwarder.bind(&otherTester, QEvent::Enter, unbindFunc);
+	QCoreApplication::sendEvent(&otherTester, &enterEvent);
+	QCOMPARE(otherEnterCall.count, 2);
+	QVERIFY(!forwarder.isConnected(&otherTester));
+	QCoreApplication::sendEvent(&otherTester, &enterEvent);
+	QCOMPARE(otherEnterCall.count, 2);
+
+	forwarder.unbind(&tester);
+	QCOMPARE(forwarder.bindingCount(), 0);
+	QCoreApplication::sendEvent(&tester, &collidingEvent);
+	QCOMPARE(collidingTypeCall.count, 1);
+}
+
+void TestQtSignalTools::testEventFilterPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// measure the overhead which an event binding adds to events of
+	// other types delivered to the watched object, compared to an
+	// object which is not watched
+	const int eventCount = 1000000;
+	QMouseEvent event(QEvent::MouseMove, QPoint(0,0), Qt::NoButton, Qt::NoButton, 0);
+
+	CallCounter counter;
+	CallbackTester watchedTester;
+	CallbackTester unwatchedTester;
+	QtSignalForwarder proxy;
+	proxy.bind(&watchedTester, QEvent::MouseButtonPress, incrementFunc(counter));
+
+	CallbackTester* testers[] = { &unwatchedTester, &watchedTester };
+	for (int i=0; i < 2; i++) {
+		QElapsedTimer timer;
+		timer.start();
+		for (int k=0; k < eventCount; k++) {
+			QCoreApplication::sendEvent(testers[i], &event);
+		}
+		qint64 totalNs = timer.nsecsElapsed();
+		qDebug() << (i == 0 ? "unwatched" : "watched") << "cost per mouse move event"
+		  << (totalNs / eventCount) << "ns" << "total" << (totalNs / (1000 * 1000)) << "ms";
+	}
+	QCOMPARE(counter.count, 0);
+#endif
+}
+
+void TestQtSignalTools::testClassEventBinding()
+{
+	CallbackTester parent;
+	parent.setObjectName("parent");
+	CallbackTester* child = new CallbackTester;
+	child->setParent(&parent);
+	child->setObjectName("child");
+	CallbackTester outside;
+	outside.setObjectName("outside");
+	QTimer timer;
+	timer.setObjectName("timer");
+
+	QList<QString> names;
+	function<void(QObject*)> appendName = bind(appendObjectName, &names, _1);
+	QVERIFY(QtSignalForwarder::connect(&CallbackTester::staticMetaObject, QEvent::Enter, appendName));
+
+	QEvent enterEvent(QEvent::Enter);
+	QEvent leaveEvent(QEvent::Leave);
+	QCoreApplication::sendEvent(child, &enterEvent);
+	QCoreApplication::sendEvent(&outside, &enterEvent);
+	QCoreApplication::sendEvent(&timer, &enterEvent);
+	QCoreApplication::sendEvent(child, &leaveEvent);
+	QCOMPARE(names, QList<QString>() << "child" << "outside");
+	names.clear();
+
+	// scoped bindings to a base class match objects of derived
+	// classes within the scope
+	QVERIFY(QtSignalForwarder::connect(&parent, &QObject::staticMetaObject, QEvent::Leave, appendName));
+	QCoreApplication::sendEvent(child, &leaveEvent);
+	QCoreApplication::sendEvent(&outside, &leaveEvent);
+	QCoreApplication::sendEvent(&timer, &leaveEvent);
+	QCOMPARE(names, QList<QString>() << "child");
+	names.clear();
+
+	QtSignalForwarder::disconnect(&CallbackTester::staticMetaObject, QEvent::Enter);
+	QCoreApplication::sendEvent(child, &enterEvent);
+	QCoreApplication::sendEvent(child, &leaveEvent);
+	QCOMPARE(names, QList<QString>() << "child");
+	names.clear();
+
+	QtSignalForwarder::disconnect(&parent, &QObject::staticMetaObject, QEvent::Leave);
+	QCoreApplication::sendEvent(child, &leaveEvent);
+	QCOMPARE(names, QList<QString>());
+
+	// callbacks are not required to take the object which received the event
+	CallCounter counter;
+	QVERIFY(QtSignalForwarder::connect(&QTimer::staticMetaObject, QEvent::Enter, incrementFunc(counter)));
+	QCoreApplication::sendEvent(&timer, &enterEvent);
+	QCoreApplication::sendEvent(&outside, &enterEvent);
+	QCOMPARE(counter.count, 1);
+	QtSignalForwarder::disconnect(&QTimer::staticMetaObject, QEvent::Enter);
+	QCoreApplication::sendEvent(&timer, &enterEvent);
+	QCOMPARE(counter.count, 1);
+
+	// callbacks must accept the object which received the event
+	function<void(int)> intFunc = bind(appendValue, &parent.values, _1);
+	QVERIFY(!QtSignalForwarder::connect(&QTimer::staticMetaObject, QEvent::Enter, intFunc));
+
+	// callbacks may remove the last class binding and add a new one
+	function<void(QObject*)> rebind = bind(rebindClassEvent, QEvent::Leave, appendName);
+	QVERIFY(QtSignalForwarder::connect(&CallbackTester::staticMetaObject, QEvent::Enter, rebind));
+	QCoreApplication::sendEvent(child, &enterEvent);
+	QCoreApplication::sendEvent(child, &leaveEvent);
+	QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+	QCoreApplication::sendEvent(child, &leaveEvent);
+	QCOMPARE(names, QList<QString>() << "child" << "child");
+	names.clear();
+
+	// or just remove it, in which case bindings added before the
+	// filter is cleaned up are kept
+	rebind = bind(rebindClassEvent, QEvent::None, appendName);
+	QtSignalForwarder::disconnect(&CallbackTester::staticMetaObject, QEvent::Leave);
+	QVERIFY(QtSignalForwarder::connect(&CallbackTester::staticMetaObject, QEvent::Enter, rebind));
+	QCoreApplication::sendEvent(child, &enterEvent);
+	QVERIFY(QtSignalForwarder::connect(&CallbackTester::staticMetaObject, QEvent::Leave, appendName));
+	QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+	QCoreApplication::sendEvent(child, &leaveEvent);
+	QCOMPARE(names, QList<QString>() << "child");
+	QtSignalForwarder::disconnect(&CallbackTester::staticMetaObject, QEvent::Leave);
+}
+
+struct EventRecorder
+{
+	EventRecorder(bool _consume)
+		: consume(_consume)
+	{}
+
+	bool consume;
+	QList<int> eventTypes;
+
+	bool handleEvent(QObject*, QEvent* event)
+	{
+		eventTypes << event->type();
+		return consume;
+	}
+};
+
+void TestQtSignalTools::testConsumingEventBinding()
+{
+	CallbackTester tester;
+	EventRecorder passRecorder(false);
+	EventRecorder consumeRecorder(true);
+	CallCounter laterCall;
+
+	QtSignalForwarder forwarder;
+	QVERIFY(forwarder.bindEventFilter(&tester, QEvent::Enter, bind(&EventRecorder::handleEvent, &passRecorder, _1, _2)));
+	QVERIFY(forwarder.bindEventFilter(&tester, QEvent::Enter, bind(&EventRecorder::handleEvent, &consumeRecorder, _1, _2)));
+	forwarder.bind(&tester, QEvent::Enter, incrementFunc(laterCall));
+	QVERIFY(!forwarder.bindEventFilter(&tester, QEvent::Enter, QtSignalForwarder::EventHandler()));
+	QCOMPARE(forwarder.bindingCount(), 3);
+
+	// a consumed event is not passed to later bindings or to the receiver
+	QEvent enterEvent(QEvent::Enter);
+	QVERIFY(QCoreApplication::sendEvent(&tester, &enterEvent));
+	QCOMPARE(passRecorder.eventTypes, QList<int>() << QEvent::Enter);
+	QCOMPARE(consumeRecorder.eventTypes, QList<int>() << QEvent::Enter);
+	QCOMPARE(laterCall.count, 0);
+
+	consumeRecorder.consume = false;
+	QVERIFY(!QCoreApplication::sendEvent(&tester, &enterEvent));
+	QCOMPARE(consumeRecorder.eventTypes.count(), 2);
+	QCOMPARE(laterCall.count, 1);
+
+	// handlers are removed along with other bindings for the event
+	forwarder.unbind(&tester, QEvent::Enter);
+	QCOMPARE(forwarder.bindingCount(), 0);
+	QVERIFY(!QCoreApplication::sendEvent(&tester, &enterEvent));
+	QCOMPARE(passRecorder.eventTypes.count(), 2);
+
+	consumeRecorder.consume = true;
+	QVERIFY(QtSignalForwarder::connectEventFilter(&tester, QEvent::Leave,
+	  bind(&EventRecorder::handleEvent, &consumeRecorder, _1, _2)));
+	QEvent leaveEvent(QEvent::Leave);
+	QVERIFY(QCoreApplication::sendEvent(&tester, &leaveEvent));
+	QtSignalForwarder::disconnect(&tester, QEvent::Leave);
+	QVERIFY(!QCoreApplication::sendEvent(&tester, &leaveEvent));
+	QCOMPARE(consumeRecorder.eventTypes.count(), 3);
+}
+
+void appendMousePos(QList<int>* list, QObject*, QEvent* event)
+{
+	list->append(static_cast<QMouseEvent*>(event)->pos().x());
+}
+
+void TestQtSignalTools::testCoalescedEventBinding()
+{
+	CallbackTester tester;
+	QList<int> positions;
+	QtSignalForwarder::EventCallback callback = bind(appendMousePos, &positions, _1, _2);
+
+	QtSignalForwarder forwarder;
+	QVERIFY(forwarder.bindCoalesced(&tester, QEvent::MouseMove, callback));
+	QCOMPARE(forwarder.bindingCount(), 1);
+
+	// events are delivered on the next event loop iteration,
+	// with only the latest event being passed to the callback
+	for (int x=0; x < 3; x++) {
+		QMouseEvent event(QEvent::MouseMove, QPoint(x,0), Qt::NoButton, Qt::NoButton, 0);
+		QCoreApplication::sendEvent(&tester, &event);
+	}
+	QCOMPARE(positions, QList<int>());
+	QTest::qWait(20);
+	QCOMPARE(positions, QList<int>() << 2);
+	positions.clear();
+
+	// removing the binding cancels a pending delivery
+	QMouseEvent event(QEvent::MouseMove, QPoint(5,0), Qt::NoButton, Qt::NoButton, 0);
+	QCoreApplication::sendEvent(&tester, &event);
+	forwarder.unbind(&tester, QEvent::MouseMove);
+	QCOMPARE(forwarder.bindingCount(), 0);
+	QTest::qWait(20);
+	QCOMPARE(positions, QList<int>());
+
+	// with an interval, deliveries are spaced at least the interval apart
+	const int interval = 100;
+	QVERIFY(QtSignalForwarder::connectCoalesced(&tester, QEvent::MouseMove, callback, interval));
+	QCoreApplication::sendEvent(&tester, &event);
+	QTest::qWait(20);
+	QCOMPARE(positions, QList<int>());
+	QTest::qWait(interval * 2);
+	QCOMPARE(positions, QList<int>() << 5);
+	QtSignalForwarder::disconnect(&tester, QEvent::MouseMove);
+
+	QVERIFY(!forwarder.bindCoalesced(&tester, QEvent::MouseMove, QtSignalForwarder::EventCallback()));
+}
+
+void TestQtSignalTools::testCoalescedEventBindingPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// compare the number of callback invocations and the cost of delivering a
+	// burst of mouse move events with and without coalescing
+	const int eventCount = 100000;
+	QMouseEvent event(QEvent::MouseMove, QPoint(0,0), Qt::NoButton, Qt::NoButton, 0);
+	CallbackTester tester;
+
+	for (int pass=0; pass < 2; pass++) {
+		bool coalesce = pass > 0;
+		CallCounter counter;
+		QtSignalForwarder proxy;
+		if (coalesce) {
+			proxy.bindCoalesced(&tester, QEvent::MouseMove, function<void(QObject*,QEvent*)>(
+			  bind(&CallCounter::increment, &counter)));
+		} else {
+			proxy.bind(&tester, QEvent::MouseMove, incrementFunc(counter));
+		}
+
+		QElapsedTimer timer;
+		timer.start();
+		for (int i=0; i < eventCount; i++) {
+			QCoreApplication::sendEvent(&tester, &event);
+		}
+		QTest::qWait(20);
+		qint64 totalNs = timer.nsecsElapsed();
+		qDebug() << (coalesce ? "coalesced" : "synchronous") << "delivery of" << eventCount << "events."
+		  << "callbacks" << counter.count << "total" << (totalNs / (1000 * 1000)) << "ms";
+	}
+#endif
+}
+
+void TestQtSignalTools::testDebouncedBinding()
+{
+	const int interval = 50;
+	CallbackTester tester;
+	QList<int> values;
+	function<void(int)> appendFunc = bind(appendValue, &values, _1);
+
+	QtSignalForwarder forwarder;
+	QtSignalForwarder::Connection connection =
+	  forwarder.bindDebounced(&tester, SIGNAL(aSignal(int)), 0, appendFunc, interval);
+	QVERIFY(connection);
+
+	// the callback is invoked once with the latest arguments after
+	// the emissions stop
+	tester.emitASignal(1);
+	tester.emitASignal(2);
+	tester.emitASignal(3);
+	QCOMPARE(values, QList<int>());
+	QTest::qWait(interval * 3);
+	QCOMPARE(values, QList<int>() << 3);
+	values.clear();
+
+	// removing the binding cancels a pending call
+	tester.emitASignal(4);
+	connection.disconnect();
+	QTest::qWait(interval * 3);
+	QCOMPARE(values, QList<int>());
+
+	// callbacks may take fewer arguments than the signal
+	CallCounter counter;
+	QVERIFY(QtSignalForwarder::connectDebounced(&tester, SIGNAL(aSignal(int)), 0, incrementFunc(counter), interval));
+	tester.emitASignal(5);
+	tester.emitASignal(6);
+	QTest::qWait(interval * 3);
+	QCOMPARE(counter.count, 1);
+	QtSignalForwarder::disconnect(&tester, SIGNAL(aSignal(int)));
+}
+
+void TestQtSignalTools::testThrottledBinding()
+{
+	const int interval = 100;
+	CallbackTester tester;
+	QList<int> values;
+	function<void(int)> appendFunc = bind(appendValue, &values, _1);
+
+	// leading and trailing edges
+	QtSignalForwarder forwarder;
+	QVERIFY(forwarder.bindThrottled(&tester, SIGNAL(aSignal(int)), 0, appendFunc, interval));
+	tester.emitASignal(1);
+	tester.emitASignal(2);
+	tester.emitASignal(3);
+	QCOMPARE(values, QList<int>() << 1);
+	QTest::qWait(interval * 3);
+	QCOMPARE(values, QList<int>() << 1 << 3);
+	forwarder.unbind(&tester);
+	values.clear();
+
+	// leading edge only
+	QVERIFY(forwarder.bindThrottled(&tester, SIGNAL(aSignal(int)), 0, appendFunc, interval,
+	  QtSignalForwarder::LeadingEdge));
+	tester.emitASignal(1);
+	tester.emitASignal(2);
+	QCOMPARE(values, QList<int>() << 1);
+	QTest::qWait(interval * 3);
+	QCOMPARE(values, QList<int>() << 1);
+	forwarder.unbind(&tester);
+	values.clear();
+
+	// trailing edge only
+	QVERIFY(forwarder.bindThrottled(&tester, SIGNAL(aSignal(int)), 0, appendFunc, interval,
+	  QtSignalForwarder::TrailingEdge));
+	tester.emitASignal(1);
+	tester.emitASignal(2);
+	QCOMPARE(values, QList<int>());
+	QTest::qWait(interval * 3);
+	QCOMPARE(values, QList<int>() << 2);
+	forwarder.unbind(&tester);
+	values.clear();
+
+	QVERIFY(!forwarder.bindThrottled(&tester, SIGNAL(aSignal(int)), 0, appendFunc, interval, 0));
+	QCOMPARE(forwarder.bindingCount(), 0);
+}
+
+void TestQtSignalTools::testRateLimitedBindingPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// measure the cost of emissions to a throttled binding, which
+	// only keeps the latest arguments, against a plain binding
+	const int emitCount = 100000;
+	CallbackTester tester;
+	CallCounter counter;
+
+	for (int pass=0; pass < 2; pass++) {
+		bool throttle = pass > 0;
+		QtSignalForwarder proxy;
+		if (throttle) {
+			proxy.bindThrottled(&tester, SIGNAL(aSignal(int)), 0, incrementFunc(counter), 1000);
+		} else {
+			proxy.bind(&tester, SIGNAL(aSignal(int)), incrementFunc(counter));
+		}
+
+		QElapsedTimer timer;
+		timer.start();
+		for (int i=0; i < emitCount; i++) {
+			tester.emitASignal(i);
+		}
+		qint64 totalNs = timer.nsecsElapsed();
+		qDebug() << (throttle ? "throttled" : "plain") << "cost per emit" << (totalNs / emitCount) << "ns"
+		  << "total" << (totalNs / (1000 * 1000)) << "ms";
+	}
+#endif
+}
+
+bool isAboveHalfway(int value)
+{
+	return value > 50;
+}
+
+bool isPercentage(int value)
+{
+	return value >= 0 && value <= 100;
+}
+
+bool isEmptyString(const QString& value)
+{
+	return value.isEmpty();
+}
+
+void appendBool(QList<bool>* list, bool value)
+{
+	list->append(value);
+}
+
+void TestQtSignalTools::testPipeline()
+{
+	CallbackTester tester;
+	QList<bool> results;
+	function<void(bool)> appendFunc = bind(appendBool, &results, _1);
+
+	QtSignalForwarder::Pipeline pipeline;
+	pipeline.filter(isPercentage).map(isAboveHalfway).distinct<bool>();
+
+	QtSignalForwarder forwarder;
+	QVERIFY(forwarder.bind(&tester, SIGNAL(aSignal(int)), 0, pipeline, appendFunc));
+	QList<int> inputs = QList<int>() << 10 << 20 << 200 << 60 << 70 << -5 << 40;
+	Q_FOREACH(int input, inputs) {
+		tester.emitASignal(input);
+	}
+	QCOMPARE(results, QList<bool>() << false << true << false);
+	results.clear();
+
+	// each binding has its own state for the distinct() stage
+	QtSignalForwarder::Connection connection = QtSignalForwarder::connect(&tester, SIGNAL(aSignal(int)), 0,
+	  pipeline, appendFunc);
+	QVERIFY(connection);
+	tester.emitASignal(30);
+	QCOMPARE(results, QList<bool>() << false);
+	connection.disconnect();
+	forwarder.unbind(&tester);
+	results.clear();
+
+	// stage types are checked against the signal and the callback
+	QtSignalForwarder::Pipeline stringPipeline;
+	stringPipeline.filter(isEmptyString);
+	QVERIFY(!forwarder.bind(&tester, SIGNAL(aSignal(int)), 0, stringPipeline, appendFunc));
+	QVERIFY(!forwarder.bind(&tester, SIGNAL(noArgSignal()), 0, pipeline, appendFunc));
+	QList<QString> strings;
+	function<void(QString)> stringFunc = bind(appendString, &strings, _1);
+	QVERIFY(!forwarder.bind(&tester, SIGNAL(aSignal(int)), 0, pipeline, stringFunc));
+	QCOMPARE(forwarder.bindingCount(), 0);
+
+	// a filter which keeps the value's type
+	QtSignalForwarder::Pipeline filterPipeline;
+	filterPipeline.filter(isAboveHalfway);
+	QVERIFY(forwarder.bind(&tester, SIGNAL(aSignal(int)), 0, filterPipeline,
+	  QtCallback(&tester, SLOT(addValue(int)))));
+	tester.values.clear();
+	tester.emitASignal(10);
+	tester.emitASignal(90);
+	QCOMPARE(tester.values, QList<int>() << 90);
+}
+
+void TestQtSignalTools::testPipelinePerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// measure the cost of emissions where a pipeline drops most of the values
+	// against a plain binding which receives every value
+	const int emitCount = 100000;
+	CallbackTester tester;
+	CallCounter counter;
+
+	QtSignalForwarder::Pipeline pipeline;
+	pipeline.map(isAboveHalfway).distinct<bool>();
+
+	for (int pass=0; pass < 2; pass++) {
+		bool usePipeline = pass > 0;
+		counter.count = 0;
+		QtSignalForwarder proxy;
+		if (usePipeline) {
+			proxy.bind(&tester, SIGNAL(aSignal(int)), 0, pipeline, incrementFunc(counter));
+		} else {
+			proxy.bind(&tester, SIGNAL(aSignal(int)), incrementFunc(counter));
+		}
+
+		QElapsedTimer timer;
+		timer.start();
+		for (int i=0; i < emitCount; i++) {
+			tester.emitASignal(i % 100);
+		}
+		qint64 totalNs = timer.nsecsElapsed();
+		qDebug() << (usePipeline ? "pipeline" : "plain") << "cost per emit" << (totalNs / emitCount) << "ns"
+		  << "callbacks" << counter.count << "total" << (totalNs / (1000 * 1000)) << "ms";
+	}
+#endif
+}
+
+// appends @p remaining to @p values and schedules a call to append
+// the next lower value, down to 0
+void scheduleDelayedCalls(QList<int>* values, int remaining)
+{
+	values->append(remaining);
+	if (remaining > 0) {
+		QtSignalForwarder::delayedCall(0, function<void()>(bind(scheduleDelayedCalls, values, remaining - 1)));
+	}
+}
+
+void TestQtSignalTools::testDelayedCallScheduling()
+{
+	QList<int> values;
+	QObject* context = new QObject;
+
+	// calls are made in order of their due time, and calls due
+	// at the same time are made in the order they were scheduled
+	QtSignalForwarder::delayedCall(150, function<void()>(bind(appendValue, &values, 150)));
+	QtSignalForwarder::delayedCall(10, function<void()>(bind(appendValue, &values, 10)));
+	QtSignalForwarder::delayedCall(80, function<void()>(bind(appendValue, &values, 80)));
+	QtSignalForwarder::delayedCall(10, function<void()>(bind(appendValue, &values, 11)));
+	QtSignalForwarder::delayedCall(0, function<void()>(bind(appendValue, &values, 0)));
+
+	// calls are skipped if their context is destroyed first
+	QtSignalForwarder::delayedCall(20, context, function<void()>(bind(appendValue, &values, -1)));
+	delete context;
+
+	QTest::qWait(400);
+	QCOMPARE(values, QList<int>() << 0 << 10 << 11 << 80 << 150);
+
+	// calls may schedule further calls while they are being made
+	values.clear();
+	scheduleDelayedCalls(&values, 3);
+	QTest::qWait(100);
+	QCOMPARE(values, QList<int>() << 3 << 2 << 1 << 0);
+}
+
+void TestQtSignalTools::testDelayedCallHandle()
+{
+	QList<int> values;
+
+	QtSignalForwarder::DelayedCall emptyCall;
+	QVERIFY(!emptyCall.isPending());
+	QVERIFY(!emptyCall.reschedule(10));
+	emptyCall.cancel();
+
+	QtSignalForwarder::DelayedCall cancelledCall =
+	  QtSignalForwarder::delayedCall(20, function<void()>(bind(appendValue, &values, 1)));
+	QtSignalForwarder::DelayedCall movedCall =
+	  QtSignalForwarder::delayedCall(10, function<void()>(bind(appendValue, &values, 2)));
+	QtSignalForwarder::DelayedCall call =
+	  QtSignalForwarder::delayedCall(50, function<void()>(bind(appendValue, &values, 3)));
+	QVERIFY(cancelledCall.isPending());
+
+	cancelledCall.cancel();
+	QVERIFY(!cancelledCall.isPending());
+	QVERIFY(!cancelledCall.reschedule(10));
+	QVERIFY(movedCall.reschedule(100));
+	QVERIFY(movedCall.isPending());
+
+	QTest::qWait(300);
+	QCOMPARE(values, QList<int>() << 3 << 2);
+	QVERIFY(!call.isPending());
+	QVERIFY(!movedCall.isPending());
+	QVERIFY(!movedCall.reschedule(10));
+
+	// handles to calls which have been made do not affect
+	// later calls which reuse their storage
+	values.clear();
+	QtSignalForwarder::DelayedCall laterCall =
+	  QtSignalForwarder::delayedCall(10, function<void()>(bind(appendValue, &values, 4)));
+	call.cancel();
+	movedCall.cancel();
+	QVERIFY(laterCall.isPending());
+	QTest::qWait(100);
+	QCOMPARE(values, QList<int>() << 4);
+}
+
+void appendValueAndString(QList<int>* values, QStringList* strings, int value, const QString& string)
+{
+	values->append(value);
+	strings->append(string);
+}
+
+void TestQtSignalTools::testMetacallInvoke()
+{
+	int value = 7;
+	QString string("seven");
+	void* args[] = {0, &value, &string};
+	int types[] = {QMetaType::Int, QMetaType::QString};
+
+	QList<int> values;
+	QStringList strings;
+	QtMetacallAdapter funcAdapter(function<void(int,QString)>(bind(appendValueAndString, &values, &strings, _1, _2)));
+	QVERIFY(funcAdapter.invokeMetacall(args, types, 2));
+	QCOMPARE(values, QList<int>() << 7);
+	QCOMPARE(strings, QStringList() << "seven");
+
+	// check that too few arguments are rejected
+	QVERIFY(!funcAdapter.invokeMetacall(args, types, 1));
+	QCOMPARE(values, QList<int>() << 7);
+
+	CallbackTester tester;
+	QtMetacallAdapter callbackAdapter(QtCallback(&tester, SLOT(addValue(int))));
+	QVERIFY(callbackAdapter.invokeMetacall(args, types, 1));
+	QCOMPARE(tester.values, QList<int>() << 7);
+
+	// signal emissions take the same path
+	QtSignalForwarder::connect(&tester, SIGNAL(aSignal(int)), QtCallback(&tester, SLOT(addValue(int))));
+	tester.emitASignal(8);
+	QCOMPARE(tester.values, QList<int>() << 7 << 8);
+}
+
+#ifdef QST_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+QString tenArgsResult;
+
+void joinTenArgs(int a, const QString& b, double c, int d, const QString& e,
+                 double f, int g, const QString& h, double i, int j)
+{
+	tenArgsResult = QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10")
+	  .arg(a).arg(b).arg(c).arg(d).arg(e).arg(f).arg(g).arg(h).arg(i).arg(j);
+}
+
+void storeStringAddress(const QString** address, const QString& string)
+{
+	*address = &string;
+}
+#endif
+
+void TestQtSignalTools::testVariadicAdapter()
+{
+#ifdef QST_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+	// adapters support functions with as many arguments as a Qt signal
+	QtMetacallAdapter adapter(joinTenArgs);
+	QtMetacallArgsArray argTypes = {-1};
+	QCOMPARE(adapter.getArgTypes(argTypes), 10);
+	const int expectedTypes[10] = {QMetaType::Int, QMetaType::QString, QMetaType::Double,
+	                               QMetaType::Int, QMetaType::QString, QMetaType::Double,
+	                               QMetaType::Int, QMetaType::QString, QMetaType::Double,
+	                               QMetaType::Int};
+	for (int i=0; i < 10; i++) {
+		QCOMPARE(argTypes[i], expectedTypes[i]);
+	}
+
+	int ints[4] = {1, 4, 7, 10};
+	QString strings[3] = {"two", "five", "eight"};
+	double doubles[3] = {3.5, 6.5, 9.5};
+	void* metacallArgs[11] = {0, &ints[0], &strings[0], &doubles[0], &ints[1], &strings[1],
+	                          &doubles[1], &ints[2], &strings[2], &doubles[2], &ints[3]};
+	QGenericArgument args[10];
+	for (int i=0; i < 10; i++) {
+		args[i] = QGenericArgument(QMetaType::typeName(expectedTypes[i]), metacallArgs[i+1]);
+	}
+	const QString expected("1 two 3.5 4 five 6.5 7 eight 9.5 10");
+
+	QVERIFY(adapter.invokeMetacall(metacallArgs, argTypes, 10));
+	QCOMPARE(tenArgsResult, expected);
+
+	tenArgsResult.clear();
+	QVERIFY(adapter.invoke(args, 10));
+	QCOMPARE(tenArgsResult, expected);
+	QVERIFY(!adapter.invoke(args, 9));
+
+	// reference arguments are passed through without a copy
+	QString string("value");
+	const QString* address = 0;
+	void* stringArgs[] = {0, &string};
+	int stringTypes[] = {QMetaType::QString};
+	QtMetacallAdapter refAdapter(function<void(const QString&)>(bind(storeStringAddress, &address, _1)));
+	QVERIFY(refAdapter.invokeMetacall(stringArgs, stringTypes, 1));
+	QCOMPARE(address, static_cast<const QString*>(&string));
+#else
+	SKIP_TEST("Compiler does not support C++11 variadic templates");
+#endif
+}
+
+// function object which is too large to be stored inline
+// in a QtMetacallAdapter
+template <class Signature>
+struct LargeFunction;
+
+template <>
+struct LargeFunction<void(int)>
+{
+	LargeFunction(int* _total)
+		: total(_total)
+	{}
+
+	void operator()(int value) const
+	{
+		*total += value;
+	}
+
+	int* total;
+	char padding[256];
+};
+
+void TestQtSignalTools::testAdapterStorage()
+{
+	int value = 3;
+	QGenericArgument args[] = {Q_ARG(int, value)};
+
+	// small function objects are stored inline and copied
+	// along with the adapter
+	QList<int> values;
+	function<void(int)> appendFunc(bind(appendValue, &values, _1));
+	QScopedPointer<QtMetacallAdapter> original(new QtMetacallAdapter(appendFunc));
+	QtMetacallAdapter copy(*original);
+	QtMetacallAdapter assigned;
+	QVERIFY(assigned.isNull());
+	assigned = copy;
+	QVERIFY(copy == *original);
+	QVERIFY(assigned == *original);
+	QVERIFY(QtMetacallAdapter(appendFunc) != *original);
+	original.reset();
+	QVERIFY(copy.invoke(args, 1));
+	QVERIFY(assigned.invoke(args, 1));
+	QCOMPARE(values, QList<int>() << 3 << 3);
+
+	// large function objects are allocated on the heap and shared
+	// between copies
+	int total = 0;
+	QScopedPointer<QtMetacallAdapter> large(new QtMetacallAdapter(LargeFunction<void(int)>(&total)));
+	QtMetacallAdapter largeCopy(*large);
+	QVERIFY(largeCopy == *large);
+	QVERIFY(QtMetacallAdapter(LargeFunction<void(int)>(&total)) != *large);
+	large.reset();
+	QVERIFY(largeCopy.invoke(args, 1));
+	QCOMPARE(total, 3);
+
+	assigned = largeCopy;
+	QVERIFY(assigned == largeCopy);
+	QVERIFY(assigned.invoke(args, 1));
+	QCOMPARE(total, 6);
+
+	QVERIFY(QtMetacallAdapter() == QtMetacallAdapter());
+}
+
+void TestQtSignalTools::testUnwrappedFunctionObjects()
+{
+#ifdef QST_COMPILER_SUPPORTS_LAMBDAS
+	// lambdas can be connected without wrapping them in function<>
+	CallbackTester tester;
+	int sum = 0;
+	QVERIFY(QtSignalForwarder::connect(&tester, SIGNAL(aSignal(int)), [&](int value) { sum += value; }));
+
+	// mutable lambdas can modify their captured state
+	int count = 0;
+	int lastCount = 0;
+	QVERIFY(QtSignalForwarder::connect(&tester, SIGNAL(aSignal(int)), [&lastCount, count](int) mutable {
+		lastCount = ++count;
+	}));
+
+	// argument types are still checked when connecting
+	QVERIFY(!QtSignalForwarder::connect(&tester, SIGNAL(aSignal(int)), [](const QString&) {}));
+
+	tester.emitASignal(12);
+	tester.emitASignal(7);
+	QCOMPARE(sum, 19);
+	QCOMPARE(lastCount, 2);
+	QCOMPARE(count, 0);
+
+	// safe_bind() wrappers take the signature of the bound method
+	QScopedPointer<QObject> object(new QObject);
+	QVERIFY(QtSignalForwarder::connect(&tester, SIGNAL(stringSignal(QString)),
+	  safe_bind(object.data(), &QObject::setObjectName)));
+	tester.emitStringSignal("objectName");
+	QCOMPARE(object->objectName(), QString("objectName"));
+
+	QtMetacallAdapter getName(safe_bind(object.data(), &QObject::objectName));
+	QtMetacallArgsArray argTypes;
+	QCOMPARE(getName.getArgTypes(argTypes), 0);
+	object.reset();
+	tester.emitStringSignal("destroyed");
+#else
+	SKIP_TEST("Compiler does not support C++11 lambdas");
+#endif
+}
+
+void TestQtSignalTools::testTypedSignalConnect()
+{
+#ifdef QST_SUPPORTS_TYPED_SIGNALS
+	CallbackTester tester;
+	int sum = 0;
+	QVERIFY(QtSignalForwarder::connect(&tester, &CallbackTester::aSignal, [&](int value) { sum += value; }));
+
+	// signal arguments are converted to the receiver's argument types
+	// and receivers may take fewer arguments than the signal
+	double doubleSum = 0;
+	QVERIFY(QtSignalForwarder::connect(&tester, &CallbackTester::aSignal, [&](double value) { doubleSum += value; }));
+	int emitCount = 0;
+	QVERIFY(QtSignalForwarder::connect(&tester, &CallbackTester::aSignal, [&]() { ++emitCount; }));
+
+	tester.emitASignal(4);
+	tester.emitASignal(5);
+	QCOMPARE(sum, 9);
+	QCOMPARE(doubleSum, 9.0);
+	QCOMPARE(emitCount, 2);
+
+	// function pointers and reference arguments
+	QString lastString;
+	QVERIFY(QtSignalForwarder::connect(&tester, &CallbackTester::stringSignal,
+	  [&](const QString& value) { lastString = value; }));
+	tester.emitStringSignal("typed");
+	QCOMPARE(lastString, QString("typed"));
+	QVERIFY(QtSignalForwarder::connect(&tester, &CallbackTester::aSignal, intFunc));
+
+	// arguments whose types are not registered are passed straight through
+	int unregisteredValue = 0;
+	QVERIFY(QtSignalForwarder::connect(&tester, &CallbackTester::unregisteredSignal,
+	  [&](const UnregisteredValue& value) { unregisteredValue = value.value; }));
+	UnregisteredValue value = {42};
+	tester.emitUnregisteredSignal(value);
+	QCOMPARE(unregisteredValue, 42);
+
+	// typed bindings are removed with their context or connection handle
+	QScopedPointer<QObject> context(new QObject);
+	int contextCount = 0;
+	QVERIFY(QtSignalForwarder::connect(&tester, &CallbackTester::noArgSignal, context.data(), [&]() { ++contextCount; }));
+	QtSignalForwarder::Connection connection =
+	  QtSignalForwarder::connect(&tester, &CallbackTester::noArgSignal, [&]() { ++contextCount; });
+	tester.emitNoArgSignal();
+	QCOMPARE(contextCount, 2);
+	context.reset();
+	connection.disconnect();
+	tester.emitNoArgSignal();
+	QCOMPARE(contextCount, 2);
+#else
+	SKIP_TEST("Pointer-to-member signal connections require Qt 5 and C++11");
+#endif
+}
+
+// disconnects the binding which invoked it, then uses the bound
+// string stored in the function object
+void disconnectSelf(QtSignalForwarder::Connection* connection, const QString& label, QStringList* labels)
+{
+	connection->disconnect();
+	labels->append(label + " after disconnect");
+}
+
+void unbindSender(QtSignalForwarder* proxy, QObject* sender, const QString& label, QStringList* labels)
+{
+	proxy->unbind(sender);
+	labels->append(label + " after unbind");
+}
+
+void TestQtSignalTools::testDisconnectFromCallback()
+{
+	CallbackTester tester;
+	QtSignalForwarder proxy;
+	QStringList labels;
+
+	// single binding for the signal
+	QtSignalForwarder::Connection connection;
+	connection = proxy.bind(&tester, SIGNAL(noArgSignal()),
+	  function<void()>(bind(disconnectSelf, &connection, QString("only"), &labels)));
+	tester.emitNoArgSignal();
+	tester.emitNoArgSignal();
+	QCOMPARE(labels, QStringList() << "only after disconnect");
+	QCOMPARE(proxy.bindingCount(), 0);
+
+	// several bindings for the signal
+	labels = QStringList();
+	QtSignalForwarder::Connection first;
+	QtSignalForwarder::Connection second;
+	first = proxy.bind(&tester, SIGNAL(noArgSignal()),
+	  function<void()>(bind(disconnectSelf, &first, QString("first"), &labels)));
+	second = proxy.bind(&tester, SIGNAL(noArgSignal()),
+	  function<void()>(bind(disconnectSelf, &second, QString("second"), &labels)));
+	tester.emitNoArgSignal();
+	tester.emitNoArgSignal();
+	QCOMPARE(labels, QStringList() << "first after disconnect" << "second after disconnect");
+	QCOMPARE(proxy.bindingCount(), 0);
+
+	// removing all of the sender's bindings from a callback
+	labels = QStringList();
+	proxy.bind(&tester, SIGNAL(aSignal(int)),
+	  function<void()>(bind(unbindSender, &proxy, &tester, QString("sender"), &labels)));
+	tester.emitASignal(1);
+	tester.emitASignal(2);
+	QCOMPARE(labels, QStringList() << "sender after unbind");
+	QVERIFY(!proxy.isConnected(&tester));
+}
+
+// adds @p count bindings to the proxy which invoked it, enough to make
+// the proxy's binding storage grow, then uses the bound string stored
+// in the function object
+void bindMany(QtSignalForwarder* proxy, QObject* sender, int count, const QString& label, QStringList* labels)
+{
+	for (int i=0; i < count; i++) {
+		proxy->bind(sender, SIGNAL(aSignal(int)), noArgsFunc);
+	}
+	labels->append(label + " after bind");
+}
+
+void TestQtSignalTools::testBindFromCallback()
+{
+	CallbackTester tester;
+	QtSignalForwarder proxy;
+	QStringList labels;
+	const int bindCount = 1000;
+
+	// single binding for the signal
+	proxy.bind(&tester, SIGNAL(noArgSignal()),
+	  function<void()>(bind(bindMany, &proxy, &tester, bindCount, QString("only"), &labels)));
+	tester.emitNoArgSignal();
+	QCOMPARE(labels, QStringList() << "only after bind");
+	QCOMPARE(proxy.bindingCount(), bindCount + 1);
+
+	// several bindings for the signal
+	labels = QStringList();
+	proxy.bind(&tester, SIGNAL(noArgSignal()),
+	  function<void()>(bind(bindMany, &proxy, &tester, bindCount, QString("second"), &labels)));
+	tester.emitNoArgSignal();
+	QCOMPARE(labels, QStringList() << "only after bind" << "second after bind");
+	QCOMPARE(proxy.bindingCount(), bindCount * 3 + 2);
+}
+
+void TestQtSignalTools::testDelayedCallPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// schedule a large number of calls spread over a second and measure
+	// the cost of scheduling and of making the calls
+	const int callCount = 100000;
+	const int maxDelay = 1000;
+	CallCounter counter;
+	function<void()> incrementFunc = bind(&CallCounter::increment, &counter);
+
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0; i < callCount; i++) {
+		QtSignalForwarder::delayedCall((i * 7919) % maxDelay, incrementFunc);
+	}
+	qint64 scheduleNs = timer.nsecsElapsed();
+
+	timer.restart();
+	while (counter.count < callCount && timer.elapsed() < maxDelay * 10) {
+		QCoreApplication::processEvents();
+	}
+	qint64 runMs = timer.elapsed();
+
+	qDebug() << "cost per delayed call scheduled" << (scheduleNs / callCount) << "ns"
+	  << "total" << (scheduleNs / (1000 * 1000)) << "ms,"
+	  << "calls completed after" << runMs << "ms";
+	QCOMPARE(counter.count, callCount);
+
+	// calls which schedule further calls
+	QList<int> values;
+	scheduleDelayedCalls(&values, 1000);
+	timer.restart();
+	while (values.count() < 1001 && timer.elapsed() < maxDelay * 10) {
+		QCoreApplication::processEvents();
+	}
+	QCOMPARE(values.count(), 1001);
+#endif
+}
+
+void TestQtSignalTools::testDelayedCallReschedulePerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// measure the cost of repeatedly pushing back pending calls,
+	// as when waiting for edits to settle
+	const int callCount = 1000;
+	const int rescheduleCount = 100;
+	CallCounter counter;
+	function<void()> incrementFunc = bind(&CallCounter::increment, &counter);
+
+	QVector<QtSignalForwarder::DelayedCall> calls;
+	for (int i=0; i < callCount; i++) {
+		calls << QtSignalForwarder::delayedCall(1000, incrementFunc);
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	for (int k=0; k < rescheduleCount; k++) {
+		for (int i=0; i < callCount; i++) {
+			calls[i].reschedule(1000 + (k * 37 + i) % 500);
+		}
+	}
+	qint64 totalNs = timer.nsecsElapsed();
+	qDebug() << "cost per reschedule" << (totalNs / (callCount * rescheduleCount)) << "ns"
+	  << "total" << (totalNs / (1000 * 1000)) << "ms";
+
+	for (int i=0; i < callCount; i++) {
+		calls[i].cancel();
+	}
+	QCOMPARE(counter.count, 0);
+#endif
+}
+
+void TestQtSignalTools::testMetacallInvokePerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// compare invoking adapters with a QGenericArgument array against
+	// passing the qt_metacall() argument vector through
+	const int invokeCount = 1000000;
+
+	CallCounter counter;
+	CallbackTester tester;
+	QtMetacallAdapter adapters[] = {
+		QtMetacallAdapter(function<void(int)>(bind(&CallCounter::increment, &counter))),
+		QtMetacallAdapter(QtCallback(&tester, SLOT(addValue(int))))
+	};
+	const char* adapterNames[] = {"function", "QtCallback"};
+
+	int value = 42;
+	void* metacallArgs[] = {0, &value};
+	int types[] = {QMetaType::Int};
+
+	for (int i=0; i < 2; i++) {
+		tester.values.clear();
+		QElapsedTimer timer;
+		timer.start();
+		for (int k=0; k < invokeCount; k++) {
+			QGenericArgument args[] = {QGenericArgument("int", metacallArgs[1])};
+			adapters[i].invoke(args, 1);
+		}
+		qint64 genericNs = timer.nsecsElapsed();
+
+		tester.values.clear();
+		timer.restart();
+		for (int k=0; k < invokeCount; k++) {
+			adapters[i].invokeMetacall(metacallArgs, types, 1);
+		}
+		qint64 metacallNs = timer.nsecsElapsed();
+
+		qDebug() << adapterNames[i] << "cost per invoke with QGenericArgument" << (genericNs / invokeCount) << "ns"
+		  << "with argument vector" << (metacallNs / invokeCount) << "ns";
+	}
+	QCOMPARE(counter.count, invokeCount * 2);
+#endif
+}
+
+void TestQtSignalTools::testArgTypesPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// measure the cost of retrieving a receiver's argument types, which
+	// happens for every connection when checking types against the signal
+	const int lookupCount = 1000000;
+
+	QtMetacallAdapter adapter(fiveArgFunc);
+	QtMetacallArgsArray argTypes;
+	int total = 0;
+
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0; i < lookupCount; i++) {
+		total += adapter.getArgTypes(argTypes);
+	}
+	qint64 totalNs = timer.nsecsElapsed();
+	qDebug() << "cost per argument type lookup" << (totalNs / lookupCount) << "ns"
+	  << "total" << (totalNs / (1000 * 1000)) << "ms";
+
+	QCOMPARE(total, lookupCount * 5);
+#endif
+}
+
+void TestQtSignalTools::testAdapterCopyPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// measure the cost of creating and copying adapters, as happens
+	// when storing a binding
+	const int adapterCount = 100000;
+
+	CallCounter counter;
+	function<void()> incrementFunc = bind(&CallCounter::increment, &counter);
+
+	QElapsedTimer timer;
+	timer.start();
+	QVector<QtMetacallAdapter> adapters;
+	adapters.reserve(adapterCount);
+	for (int i=0; i < adapterCount; i++) {
+		adapters.append(QtMetacallAdapter(incrementFunc));
+	}
+	qint64 createNs = timer.nsecsElapsed();
+
+	timer.restart();
+	QVector<QtMetacallAdapter> copies;
+	copies.reserve(adapterCount);
+	for (int i=0; i < adapterCount; i++) {
+		copies.append(adapters.at(i));
+	}
+	qint64 copyNs = timer.nsecsElapsed();
+
+	timer.restart();
+	for (int i=0; i < adapterCount; i++) {
+		copies.at(i).invoke(0, 0);
+	}
+	qint64 invokeNs = timer.nsecsElapsed();
+
+	qDebug() << "cost per adapter create" << (createNs / adapterCount) << "ns"
+	  << "copy" << (copyNs / adapterCount) << "ns"
+	  << "invoke" << (invokeNs / adapterCount) << "ns";
+
+	QCOMPARE(counter.count, adapterCount);
+#endif
+}
+
+void TestQtSignalTools::testLambdaEmitPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+#ifdef QST_COMPILER_SUPPORTS_LAMBDAS
+	// compare the cost of invoking a lambda wrapped in function<>
+	// with invoking the lambda directly
+	const int emitCount = 1000000;
+
+	int sum = 0;
+	auto addValue = [&sum](int value) { sum += value; };
+
+	CallbackTester wrappedSender;
+	QtSignalForwarder::connect(&wrappedSender, SIGNAL(aSignal(int)), function<void(int)>(addValue));
+	CallbackTester directSender;
+	QtSignalForwarder::connect(&directSender, SIGNAL(aSignal(int)), addValue);
+
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0; i < emitCount; i++) {
+		wrappedSender.emitASignal(1);
+	}
+	qint64 wrappedNs = timer.nsecsElapsed();
+
+	timer.restart();
+	for (int i=0; i < emitCount; i++) {
+		directSender.emitASignal(1);
+	}
+	qint64 directNs = timer.nsecsElapsed();
+
+	qDebug() << "cost per emit with wrapped lambda" << (wrappedNs / emitCount) << "ns"
+	  << "with direct lambda" << (directNs / emitCount) << "ns";
+
+	QCOMPARE(sum, emitCount * 2);
+#endif
+#endif
+}
+
+void TestQtSignalTools::testTypedSignalEmitPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+#ifdef QST_SUPPORTS_TYPED_SIGNALS
+	// compare the cost of emitting a signal connected by signature string
+	// with one connected by pointer-to-member
+	const int emitCount = 1000000;
+
+	int sum = 0;
+	auto addValue = [&sum](int value) { sum += value; };
+
+	CallbackTester stringSender;
+	QtSignalForwarder::connect(&stringSender, SIGNAL(aSignal(int)), addValue);
+	CallbackTester typedSender;
+	QtSignalForwarder::connect(&typedSender, &CallbackTester::aSignal, addValue);
+
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0; i < emitCount; i++) {
+		stringSender.emitASignal(1);
+	}
+	qint64 stringNs = timer.nsecsElapsed();
+
+	timer.restart();
+	for (int i=0; i < emitCount; i++) {
+		typedSender.emitASignal(1);
+	}
+	qint64 typedNs = timer.nsecsElapsed();
+
+	qDebug() << "cost per emit with signature string" << (stringNs / emitCount) << "ns"
+	  << "with pointer-to-member" << (typedNs / emitCount) << "ns";
+
+	QCOMPARE(sum, emitCount * 2);
+#endif
+#endif
+}
+
+void TestQtSignalTools::testClassEventBindingPerf()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+	SKIP_TEST("Benchmark disabled");
+
+	// compare binding an event for many objects individually with
+	// a single class binding
+	const int objectCount = 10000;
+	QVector<CallbackTester*> testers;
+	for (int i=0; i < objectCount; i++) {
+		testers << new CallbackTester;
+	}
+	QEvent enterEvent(QEvent::Enter);
+	QEvent leaveEvent(QEvent::Leave);
+
+	for (int pass=0; pass < 2; pass++) {
+		bool classBinding = pass > 0;
+		CallCounter counter;
+
+		QElapsedTimer timer;
+		timer.start();
+		if (classBinding) {
+			QtSignalForwarder::connect(&CallbackTester::staticMetaObject, QEvent::Enter, incrementFunc(counter));
+		} else {
+			Q_FOREACH(CallbackTester* tester, testers) {
+				QtSignalForwarder::connect(tester, QEvent::Enter, incrementFunc(counter));
+			}
+		}
+		qint64 connectNs = timer.nsecsElapsed();
+
+		timer.restart();
+		Q_FOREACH(CallbackTester* tester, testers) {
+			QCoreApplication::sendEvent(tester, &enterEvent);
+			QCoreApplication::sendEvent(tester, &leaveEvent);
+		}
+		qint64 dispatchNs = timer.nsecsElapsed();
+
+		qDebug() << (classBinding ? "class binding" : "per-object bindings") << "for" << objectCount << "objects."
+		  << "connect" << (connectNs / (1000 * 1000)) << "ms"
+		  << "dispatch per event" << (dispatchNs / (objectCount * 2)) << "ns";
+		QCOMPARE(counter.count, objectCount);
+
+		if (classBinding) {
+			QtSignalForwarder::disconnect(&CallbackTester::staticMetaObject, QEvent::Enter);
+		} else {
+			Q_FOREACH(CallbackTester* tester, testers) {
+				QtSignalForwarder::disconnect(tester, QEvent::Enter);
+			}
+		}
+	}
+	qDeleteAll(testers);
+#endif
+}
+
 QTEST_MAIN(TestQtSignalTools)
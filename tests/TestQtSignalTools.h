@@ -24,14 +24,64 @@ class TestQtSignalTools : public QObject
 		void testSafeBinder();
 		void testBindingCount();
 		void testManySenders();
-		void testProxyBindingLimits();
+		void testManyConnectionsPerProxy();
 		void testConnectWithSender();
 		void testContextDestroyed();
 		void testContextDestroyedEqualsSender();
 		void testContextDestroyedShared();
 		void testThread();
+		void testSignalIndexCache();
+		void testConnectEach();
+		void testSignalFanOut();
+		void testConnectionHandle();
+		void testConnectionGroup();
+		void testSharedProxyCount();
+		void testCompact();
+		void testDestructionRegistry();
+		void testLazyContextTracking();
+		void testEventFilterMask();
+		void testClassEventBinding();
+		void testConsumingEventBinding();
+		void testCoalescedEventBinding();
+		void testDebouncedBinding();
+		void testThrottledBinding();
+		void testPipeline();
+		void testDelayedCallScheduling();
+		void testDelayedCallHandle();
+		void testMetacallInvoke();
+		void testVariadicAdapter();
+		void testAdapterStorage();
+		void testUnwrappedFunctionObjects();
+		void testTypedSignalConnect();
+		void testDisconnectFromCallback();
+		void testBindFromCallback();
 
 		void testConnectPerf();
+		void testProxyScalingPerf();
+		void testConnectEachPerf();
+		void testEmitPerf();
+		void testSignalIndexCachePerf();
+		void testConnectionHandlePerf();
+		void testConnectionGroupPerf();
+		void testSharedProxyCountPerf();
+		void testEventFilterPerf();
+		void testClassEventBindingPerf();
+		void testCoalescedEventBindingPerf();
+		void testRateLimitedBindingPerf();
+		void testPipelinePerf();
+		void testDelayedCallPerf();
+		void testDelayedCallReschedulePerf();
+		void testMetacallInvokePerf();
+		void testArgTypesPerf();
+		void testAdapterCopyPerf();
+		void testLambdaEmitPerf();
+		void testTypedSignalEmitPerf();
+};
+
+// a type which is not registered with Qt's meta-type system
+struct UnregisteredValue
+{
+	int value;
 };
 
 class CallbackTester : public QObject
@@ -56,6 +106,11 @@ class CallbackTester : public QObject
 			emit stringSignal(arg);
 		}
 
+		void emitUnregisteredSignal(const UnregisteredValue& arg)
+		{
+			emit unregisteredSignal(arg);
+		}
+
 		// expose protected QObject::receivers() method
 		int receiverCount(const char* signal) const
 		{
@@ -81,4 +136,5 @@ class CallbackTester : public QObject
 		void noArgSignal();
 		void valuesChanged();
 		void stringSignal(const QString& arg);
+		void unregisteredSignal(const UnregisteredValue& arg);
 };